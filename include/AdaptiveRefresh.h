@@ -0,0 +1,97 @@
+#pragma once
+
+#include <memory>
+#include <vector>
+
+#include "glad.h"
+#include "Framebuffer.h"
+
+// Schedules the redraws of a progressive pass during playback by how much its regions
+// change. The frame is split into screen-space tiles, and each tile into the stipple
+// phases of chunk rendering (a single phase for tiled rendering). Every redrawn tile is
+// compared with its previous content on the GPU and the result is read back
+// asynchronously. Phases of tiles that change quickly are refreshed often, static ones rarely.
+class AdaptiveRefresh {
+public:
+    // One phase of one tile to draw
+    struct Draw {
+        int tile;
+        int phase;
+    };
+
+    // Compares a tile with its previous content, set up by ShaderManager
+    struct ChangeProgram {
+        GLuint programId = 0;
+        GLint currentLocation = -1;
+        GLint previousLocation = -1;
+        GLint tileRectLocation = -1;
+        GLint phaseLocation = -1;       // ivec3(stride, phase x, phase y)
+    };
+
+    AdaptiveRefresh();
+    ~AdaptiveRefresh();
+
+    // Set up the tile grid for a framebuffer whose first attachment has the given
+    // format. Each tile has stride x stride phases laid out like the chunk stipple
+    // pattern. Changing any of it resets all state.
+    void resize(int width, int height, int tileSize, GLenum format = GL_RGB8, int stride = 1);
+
+    // Mark every phase of every tile as out of date (an input other than time changed)
+    void invalidate();
+
+    // Pick up to maxDraws tile phases that are not yet rendered at this time, most urgent
+    // first. A volatile tile can get several of its phases in one call.
+    std::vector<Draw> selectTiles(float time, int maxDraws);
+
+    // Save the content of the tiles of the last selection before they are redrawn.
+    // Leaves the framebuffer bound.
+    void beginTiles(GLuint framebuffer);
+
+    // Measure how much the tiles of the last selection changed. Call with a VAO bound.
+    void measureTiles(GLuint framebufferTexture, const ChangeProgram& program);
+
+    // Collect finished change measurements. Never blocks.
+    void poll();
+
+    // Fraction of tile phases rendered at the given time
+    float getProgress(float time) const;
+
+    void getTileRect(int tile, int& x, int& y, int& width, int& height) const;
+
+private:
+    struct Cell {
+        float time = 0.0f;          // Timeline time the phase of the tile was last rendered at
+        bool valid = false;         // Rendered since the last invalidate()
+        float priority = 0.0f;      // Accumulated urgency, reset when the phase is drawn
+    };
+
+    struct Tile {
+        float changeRate = 1.0f;    // Estimated change per second of timeline time
+        int measuredPhase = 0;      // First phase drawn in the last selection
+        float pendingDelta = 0.0f;  // Time elapsed between the last two renders of that phase
+    };
+
+    struct Readback {
+        GLuint buffer = 0;
+        GLsync fence = nullptr;
+        std::vector<int> tiles;
+        std::vector<float> deltas;
+    };
+
+    std::vector<Tile> m_tiles;
+    std::vector<Cell> m_cells;      // Phase-major, so equal priorities fill a phase at a time
+    std::vector<int> m_selected;    // Tiles of the last selection, each once
+    int m_width;
+    int m_height;
+    int m_tileSize;
+    int m_columns;
+    int m_rows;
+    int m_stride;
+    GLenum m_format;
+
+    std::unique_ptr<Framebuffer> m_history;  // Previous content of redrawn tiles
+    std::unique_ptr<Framebuffer> m_changes;  // One texel per tile with the measured change
+    Readback m_readback;
+
+    void releaseReadback();
+};
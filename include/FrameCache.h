@@ -0,0 +1,113 @@
+#pragma once
+
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <list>
+#include <map>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+// Memory-bounded cache of rendered frames, so the timeline can be scrubbed back to a time
+// that was rendered before without rendering it again. Frames are keyed by the pass, the
+// timeline slice they were rendered in and a fingerprint of all other inputs, and are kept
+// compressed in RAM. The least recently used frames are dropped to stay within the budget.
+class FrameCache {
+public:
+    struct Key {
+        std::string pass;
+        int slice = -1;             // Timeline time divided by the slice duration
+        size_t fingerprint = 0;     // ShaderManager::computeFrameFingerprint
+
+        bool operator==(const Key& other) const {
+            return slice == other.slice && fingerprint == other.fingerprint && pass == other.pass;
+        }
+        bool operator!=(const Key& other) const { return !(*this == other); }
+    };
+
+    struct Stats {
+        size_t frames = 0;
+        size_t memoryBytes = 0;     // Compressed frames
+        size_t budgetBytes = 0;
+        uint64_t hits = 0;
+        uint64_t misses = 0;
+    };
+
+    explicit FrameCache(size_t budgetBytes);
+
+    // Waits for the frame being compressed
+    ~FrameCache();
+
+    // Evicts frames until the cache fits. A budget of 0 disables the cache.
+    void setBudget(size_t budgetBytes);
+    bool isEnabled() const;
+
+    // True if a frame of this quality (render scale) would be stored, that is if the key
+    // has no frame yet (nor one on its way) or only one rendered at a lower scale
+    bool wants(const Key& key, float quality) const;
+
+    // Announce a frame that is still being read back. The returned tag identifies it in
+    // store(), it travels as the FrameReadback tag.
+    uint64_t reserve(const Key& key, float quality);
+
+    // Copy the pixels (RGBA, bottom row first) of a reserved frame to be compressed and
+    // stored on the worker thread. Dropped if the worker is still busy with earlier frames.
+    void store(uint64_t tag, int width, int height, const unsigned char* pixels);
+
+    // Decompress the frame of the key and mark it as recently used. Counts a hit or a miss.
+    bool lookup(const Key& key, int& width, int& height, std::vector<unsigned char>& pixels);
+
+    void clear();
+    Stats getStats() const;
+
+private:
+    struct KeyHash {
+        size_t operator()(const Key& key) const {
+            return std::hash<std::string>()(key.pass) ^ (std::hash<int>()(key.slice) * 31u) ^ (key.fingerprint * 131u);
+        }
+    };
+
+    struct Entry {
+        Key key;
+        float quality = 0.0f;
+        int width = 0;
+        int height = 0;
+        std::vector<unsigned char> data;    // Deflated rows, delta coded per channel
+    };
+
+    struct PendingFrame {
+        Key key;
+        float quality = 0.0f;
+        int width = 0;
+        int height = 0;
+        std::vector<unsigned char> pixels;
+    };
+
+    // Most recently used first
+    std::list<Entry> m_entries;
+    std::unordered_map<Key, std::list<Entry>::iterator, KeyHash> m_index;
+    size_t m_memoryBytes;
+    size_t m_budgetBytes;
+    uint64_t m_hits;
+    uint64_t m_misses;
+
+    // Frames being read back by tag number. Reads finish in order, so a tag also retires
+    // every older one whose read failed.
+    std::map<uint64_t, std::pair<Key, float>> m_reserved;
+    uint64_t m_nextTag;
+
+    std::deque<PendingFrame> m_pending;
+    std::thread m_worker;
+    bool m_stopRequested;
+    mutable std::mutex m_mutex;
+    std::condition_variable m_workCondition;
+
+    void workerMain();
+    void insert(Entry entry);
+    void evict();
+};
@@ -0,0 +1,79 @@
+#pragma once
+
+#include <condition_variable>
+#include <cstdio>
+#include <deque>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+// Encodes read back frames on a pool of worker threads and writes them in the order
+// they were submitted. Frames go to one PNG file each, or are streamed as Y4M or raw
+// RGBA into a single file, a named pipe or stdout for an external video encoder.
+class FrameEncoder {
+public:
+    enum class Format {
+        Png,        // One file per frame
+        Y4m,        // YUV 4:4:4 (BT.601, limited range) stream
+        RawRgba     // Headerless RGBA stream, top row first
+    };
+
+    struct Frame {
+        std::string path;                   // PNG file name, unused when streaming
+        int width = 0;
+        int height = 0;
+        std::vector<unsigned char> pixels;  // RGBA, bottom row first
+    };
+
+    // A thread count of 0 uses one thread per core
+    explicit FrameEncoder(int threadCount = 0);
+
+    // Waits for the frames still being encoded
+    ~FrameEncoder();
+
+    // Stream every following frame to one destination ("-" for stdout). All streamed
+    // frames must have the same size. The fps is only used for the Y4M header.
+    bool openStream(const std::string& path, Format format, float fps);
+
+    // Queue a frame. Blocks while too many frames are waiting to be encoded.
+    void submit(Frame frame);
+
+    // Wait until every submitted frame has been written
+    void finish();
+
+    int getFailedWrites() const;
+
+    static bool parseFormat(const std::string& name, Format& format);
+
+private:
+    struct Job {
+        long long sequence = 0;
+        Frame frame;
+    };
+
+    std::vector<std::thread> m_workers;
+    std::deque<Job> m_queue;
+    long long m_nextSequence;   // Assigned to the next submitted frame
+    long long m_nextWrite;      // Next frame allowed to write, keeps the output ordered
+    int m_inProgress;
+    int m_failedWrites;
+    bool m_stopRequested;
+    mutable std::mutex m_mutex;
+    std::condition_variable m_workCondition;   // Frame queued or stop requested
+    std::condition_variable m_writeCondition;  // A frame was written (turn, space, idle)
+
+    // Stream output, written by one worker at a time in sequence order
+    Format m_format;
+    std::FILE* m_stream;
+    bool m_ownsStream;
+    float m_fps;
+    bool m_headerWritten;
+    int m_streamWidth;
+    int m_streamHeight;
+
+    void workerMain();
+    std::vector<unsigned char> encode(const Frame& frame) const;
+    bool write(const Frame& frame, const std::vector<unsigned char>& data);
+    void closeStream();
+};
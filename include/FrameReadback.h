@@ -0,0 +1,82 @@
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "glad.h"
+
+class FrameEncoder;
+
+// Reads textures back to files without stalling the render loop. Pixels are copied
+// into a ring of pixel pack buffers guarded by fences and collected a couple of frames
+// later, then handed to a FrameEncoder that encodes and writes them on worker threads.
+class FrameReadback {
+public:
+    // A finished read, valid only during the consumer call while the buffer is mapped
+    struct MappedFrame {
+        const std::string& path;
+        int width;
+        int height;
+        std::chrono::steady_clock::time_point requested;
+        const unsigned char* pixels;    // RGBA, bottom row first
+        uint64_t tag;                   // As passed to request()
+    };
+
+    // Takes the pixels straight out of the mapped buffer. Returns false if it failed.
+    using Consumer = std::function<bool(const MappedFrame& frame)>;
+
+    // Without an encoder, every frame is written as a PNG file
+    explicit FrameReadback(std::shared_ptr<FrameEncoder> encoder = nullptr, int ringSize = 3);
+
+    // Hand every finished read to the consumer (on the thread calling poll or flush)
+    // instead of copying it for an encoder
+    explicit FrameReadback(Consumer consumer, int ringSize = 3);
+
+    // GL objects must be released with release() beforehand
+    ~FrameReadback();
+
+    // Start reading the texture back. Blocks only if the whole ring is still in flight.
+    // The tag is handed back to a consumer untouched.
+    void request(GLuint textureId, const std::string& path, uint64_t tag = 0);
+
+    // Hand finished reads over to the encoder. Never waits for the GPU.
+    void poll();
+
+    // Wait until every requested frame has been written
+    void flush();
+
+    // Flush and delete the buffers. Needs a context sharing the buffers to be current.
+    void release();
+
+    // Number of frames that could not be written
+    int getFailedWrites() const;
+
+private:
+    struct Slot {
+        GLuint buffer = 0;
+        GLsizeiptr capacity = 0;
+        GLsync fence = nullptr;
+        int width = 0;
+        int height = 0;
+        std::string path;
+        uint64_t tag = 0;
+        std::chrono::steady_clock::time_point requested;
+    };
+
+    // Ring of pixel pack buffers, used by whichever thread renders
+    std::vector<Slot> m_slots;
+    int m_head;     // Next slot to issue
+    int m_pending;  // Issued but not yet collected
+    mutable std::mutex m_slotMutex;
+
+    std::shared_ptr<FrameEncoder> m_encoder;
+    Consumer m_consumer;
+    int m_failedReads;
+
+    void collect(Slot& slot, bool wait);
+};
@@ -1,24 +1,36 @@
 #pragma once
 
+#include <vector>
+
 #include "glad.h"
 
 class Framebuffer {
 public:
-    Framebuffer(int width, int height);
+    // One colour attachment per internal format (GL_RGB8 by default)
+    Framebuffer(int width, int height, const std::vector<GLenum>& formats = {GL_RGB8});
     ~Framebuffer();
 
     void bind();
     void unbind();
 
-    GLuint getTextureId() const;
+    GLuint getTextureId(int attachment = 0) const;
+    GLuint getFramebufferId() const;
     int getWidth() const;
     int getHeight() const;
+    int getAttachmentCount() const;
+    const std::vector<GLenum>& getFormats() const;
     void resize(int width, int height);
+    void setFormats(const std::vector<GLenum>& formats);
     void setFilter(GLenum filter);
 
+    // Binds the framebuffer and routes draws and reads to a single attachment, so that
+    // fragment output 0 lands in it. -1 restores drawing to all attachments.
+    void selectAttachment(int attachment);
+
 private:
     GLuint m_fbo;
-    GLuint m_textureId;
+    std::vector<GLuint> m_textureIds;
+    std::vector<GLenum> m_formats;
     GLuint m_rbo;
     int m_width;
     int m_height;
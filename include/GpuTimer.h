@@ -0,0 +1,42 @@
+#pragma once
+
+#include <vector>
+
+#include "glad.h"
+
+// Measures GPU execution time with GL_TIME_ELAPSED queries kept in a small ring.
+// Results are collected a few frames later without stalling the pipeline.
+class GpuTimer {
+public:
+    struct Sample {
+        float milliseconds = 0.0f;
+        float time = 0.0f;              // Timeline time of the measured frame
+        float renderScaleFactor = 1.0f; // Render scale used for the measured frame
+        float pixelFraction = 1.0f;     // Fraction of the target's pixels that were shaded
+        int tileCount = 0;              // Number of tiles drawn (tiled rendering only)
+    };
+
+    explicit GpuTimer(int ringSize = 4);
+    ~GpuTimer();
+
+    // Start a measurement. Returns false if all queries are still in flight,
+    // in which case this frame is not measured.
+    bool begin();
+
+    // End the measurement started by begin() and tag it with frame information
+    void end(float time, float renderScaleFactor, float pixelFraction, int tileCount = 0);
+
+    // Fetch the oldest finished measurement. Never blocks.
+    bool poll(Sample& outSample);
+
+private:
+    struct Slot {
+        GLuint query = 0;
+        Sample sample;
+    };
+
+    std::vector<Slot> m_slots;
+    int m_head;     // Next slot to issue
+    int m_pending;  // Issued but not yet collected
+    bool m_active;
+};
@@ -0,0 +1,87 @@
+#pragma once
+
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "FrameEncoder.h"
+
+class ShaderManager;
+class FrameReadback;
+class ShaderProject;
+struct ShaderPass;
+
+// Renders a project to numbered PNG frames or posters without a window or ImGui, on an
+// EGL surfaceless context. Frames are rendered at full quality with a fixed timestep, so
+// the output does not depend on how fast the machine is.
+class HeadlessRenderer {
+public:
+    struct SequenceOptions {
+        float startTime = 0.0f;
+        float endTime = 0.0f;           // Exclusive
+        float fps = 60.0f;
+        int width = 1920;
+        int height = 1080;
+        std::string output;             // Frame directory, or the stream file, pipe or "-" (stdout)
+        FrameEncoder::Format format = FrameEncoder::Format::Png;
+        int encodeThreads = 0;          // 0 uses one encoder thread per core
+    };
+
+    struct PosterOptions {
+        float time = 0.0f;
+        int width = 16384;
+        int height = 16384;
+        int supersample = 2;            // Samples per pixel along each axis
+        std::string output;             // PNG file
+    };
+
+    HeadlessRenderer();
+    ~HeadlessRenderer();
+
+    // Create the context. Fails if no EGL display supports a GL 3.3 core context.
+    bool initialize();
+
+    // Render every frame of the sequence whose file does not exist yet. Returns false
+    // if the project could not be loaded or a frame could not be written.
+    bool renderSequence(const std::string& projectPath, const SequenceOptions& options);
+
+    // The steps of renderSequence(), for callers that decide which frames to render
+    // (worker processes). The time range of the options is only validated.
+    bool beginSequence(const std::string& projectPath, const SequenceOptions& options);
+    bool renderSequenceFrame(int frame, bool& skipped);
+    bool finishSequence();
+
+    // Load a project for renderImage(), compiling all of its shaders
+    bool openProject(const std::string& projectPath);
+
+    // Render one frame of the opened project and read the final pass back synchronously
+    // as RGBA, bottom row first. Returns once the GPU has finished, so it can be timed.
+    bool renderImage(float time, int width, int height, std::vector<unsigned char>& pixels);
+
+    // Render a single still of any size as a grid of supersampled tiles, streaming each
+    // finished row of tiles into the PNG. Memory stays bounded by one row of tiles.
+    bool renderPoster(const std::string& projectPath, const PosterOptions& options);
+
+    // Frame file name for an absolute frame number (time * fps)
+    static std::string getFrameFileName(int frame);
+
+    // Absolute frame numbers covered by a sequence, the end is exclusive
+    static int getFirstFrame(const SequenceOptions& options);
+    static int getEndFrame(const SequenceOptions& options);
+
+private:
+    void* m_display;
+    void* m_context;
+    std::shared_ptr<ShaderManager> m_shaderManager;
+    std::shared_ptr<ShaderProject> m_project;
+    std::unique_ptr<FrameReadback> m_frameReadback;
+    SequenceOptions m_sequenceOptions;
+    std::string m_outputPass;
+    int m_failedFrames;
+
+    bool loadProject(const std::string& projectPath, std::string& outputPass);
+    std::pair<int, int> resolvePassSize(const ShaderPass& pass, int width, int height, int depth) const;
+    bool renderFrame(float time, int width, int height);
+    void destroyContext();
+};
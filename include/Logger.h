@@ -31,6 +31,9 @@ public:
     // Check if debug mode is enabled
     bool isDebugEnabled() const;
     
+    // Send every message to stderr, e.g. while stdout carries a video stream
+    void setLogToStderr(bool enabled);
+    
     // Main logging functions
     void debug(const std::string& message);
     void info(const std::string& message);
@@ -154,6 +157,7 @@ private:
     bool m_debugMode = false;
     bool m_colorSupport = false;
     bool m_initialized = false;
+    bool m_logToStderr = false;
 };
 
 // Convenience macros for easier usage
@@ -12,7 +12,20 @@ public:
     void render(const std::string& shaderName);
     void setProject(std::shared_ptr<ShaderProject> shaderProject);
 
+    // Take the sweep requested in the panel, to be rendered where the passes are rendered.
+    // The time is left to the caller.
+    bool takeSweepRequest(UniformSweep& sweep);
+
 private:
     std::shared_ptr<ShaderManager> m_shaderManager;
     std::shared_ptr<ShaderProject> m_shaderProject;
+
+    // Axes and grid chosen for the parameter sweep
+    UniformSweep m_sweep;
+    int m_sweepGridSize = 4;
+    bool m_sweepRequested = false;
+
+    void renderSweep(const std::string& shaderName, ShaderManager::ShaderProgram& shader);
+    void adoptSweepCell(const std::string& shaderName, ShaderManager::ShaderProgram& shader, const UniformSweep& sweep, int cell);
+    void storeUniformValues(const std::string& shaderName, const ShaderUniform& uniform);
 };
\ No newline at end of file
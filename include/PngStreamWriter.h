@@ -0,0 +1,40 @@
+#pragma once
+
+#include <cstdio>
+#include <string>
+#include <vector>
+
+#include <zlib.h>
+
+// Writes an RGB8 PNG row by row, compressing each batch of rows as it arrives, so
+// images far larger than memory (posters) can be written with a bounded footprint.
+class PngStreamWriter {
+public:
+    PngStreamWriter();
+    ~PngStreamWriter();
+
+    // Start the file. It is written under a temporary name until close() succeeds.
+    bool open(const std::string& path, int width, int height);
+
+    // Append rows, top row first, width * 3 bytes each
+    bool writeRows(const unsigned char* rows, int count);
+
+    // Finish the image. Fails if fewer rows than the height were written.
+    bool close();
+
+private:
+    std::string m_path;
+    std::string m_temporaryPath;
+    std::FILE* m_file;
+    z_stream m_stream;
+    bool m_streamInitialized;
+    int m_width;
+    int m_height;
+    int m_rowsWritten;
+    std::vector<unsigned char> m_filteredRow;
+    std::vector<unsigned char> m_compressed;
+
+    bool compress(const unsigned char* data, size_t size, int flush);
+    bool writeChunk(const char* type, const unsigned char* data, size_t size);
+    void abort();
+};
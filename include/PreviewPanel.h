@@ -1,7 +1,10 @@
 #pragma once
 
+#include <cstddef>
+#include <cstdint>
 #include <memory>
 #include <string>
+#include <utility>
 
 // Forward declare OpenGL types
 typedef unsigned int GLuint;
@@ -19,6 +22,25 @@ enum class AspectMode {
     Fixed_21_9
 };
 
+// Visible part of the preview image, normalized with the origin at the bottom-left
+struct PreviewViewRect {
+    float x = 0.0f;
+    float y = 0.0f;
+    float width = 1.0f;
+    float height = 1.0f;
+};
+
+// Frame cache state shown above the preview
+struct PreviewCacheStatus {
+    bool enabled = false;
+    bool showingCachedFrame = false;
+    size_t frames = 0;
+    size_t memoryBytes = 0;
+    size_t budgetBytes = 0;
+    uint64_t hits = 0;
+    uint64_t misses = 0;
+};
+
 class PreviewPanel {
 public:
     PreviewPanel(std::shared_ptr<ShaderManager> shaderManager);
@@ -28,11 +50,21 @@ public:
     bool initialize();
     
     // Render the preview panel
-    void render(GLuint textureId, float time, float renderScaleFactor, std::pair<float, float> uvScale = {1.0f, 1.0f});
+    void render(GLuint textureId, float time, float renderScaleFactor, std::pair<float, float> uvScale = {1.0f, 1.0f}, float renderProgress = 1.0f);
     
     // Aspect ratio settings
     AspectMode getAspectMode() const { return m_aspectMode; }
     void setAspectMode(AspectMode mode) { m_aspectMode = mode; }
+
+    // Zoom and pan (mouse wheel zooms around the cursor, right-drag pans)
+    PreviewViewRect getViewRect() const;
+    bool isZoomed() const { return m_zoom > 1.0f; }
+    void resetView();
+
+    void setCacheStatus(const PreviewCacheStatus& status) { m_cacheStatus = status; }
+
+    // Size of the displayed image in physical pixels, as of the last rendered frame ({0, 0} before that)
+    std::pair<int, int> getPreviewPixelSize() const { return m_previewPixelSize; }
     
 private:
     std::shared_ptr<ShaderManager> m_shaderManager;
@@ -42,14 +74,23 @@ private:
     
     // Shader uniforms
     float m_resolution[2];
+
+    std::pair<int, int> m_previewPixelSize;
+    PreviewCacheStatus m_cacheStatus;
+
+    // Zoom factor and center of the visible region (normalized)
+    float m_zoom;
+    float m_viewCenter[2];
     
     // OpenGL resources
     GLuint m_previewVAO;
     GLuint m_previewVBO;
     
     // Private methods
-    void renderPreviewPanel(GLuint textureId, float time, float renderScaleFactor, std::pair<float, float> uvScale);
+    void renderPreviewPanel(GLuint textureId, float time, float renderScaleFactor, std::pair<float, float> uvScale, float renderProgress);
     ImVec2 calculatePreviewSize(ImVec2 availableSize);
+    void zoomAt(float u, float v, float zoom);
+    void clampView();
     void setupPreviewQuad();
     void cleanupPreview();
 };
\ No newline at end of file
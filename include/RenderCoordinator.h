@@ -0,0 +1,66 @@
+#pragma once
+
+#include <deque>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include <sys/types.h>
+
+#include "HeadlessRenderer.h"
+
+// Renders a PNG sequence with several headless worker processes, each with its own
+// context. Frame ranges are handed out on demand, in chunks that shrink as the sequence
+// nears its end, and an idle worker takes over the back half of the busiest worker's
+// range, so frames of uneven cost still keep every worker busy until the end.
+//
+// Workers are this executable started with --sequence-worker. They read commands from
+// stdin and report every finished frame on stdout, one line each:
+//   coordinator -> worker:  "range <first> <end>"   render [first, end)
+//                           "limit <end>"           stop the current range at end
+//                           end of input            finish writing and exit
+//   worker -> coordinator:  "frame <n>"             frame n was rendered or skipped
+//                           "limited <end>"         where the range really stops
+//                           "idle"                  ready for the next range
+class RenderCoordinator {
+public:
+    // A worker count of 0 starts one worker per core
+    RenderCoordinator(const std::string& executable, int workerCount);
+    ~RenderCoordinator();
+
+    // Render the sequence with the workers. Returns false if any frame was not written.
+    bool renderSequence(const std::string& projectPath, const HeadlessRenderer::SequenceOptions& options,
+                        bool debugMode);
+
+    // Body of a worker process, serving ranges from stdin until it is closed
+    static bool runWorker(const std::string& projectPath, const HeadlessRenderer::SequenceOptions& options);
+
+private:
+    struct Worker {
+        pid_t pid = -1;
+        int commandFd = -1;     // Worker's stdin
+        int progressFd = -1;    // Worker's stdout
+        std::string input;      // Progress not yet split into lines
+        bool busy = false;
+        bool failed = false;
+        int next = 0;           // First frame of the range not reported yet
+        int end = 0;
+        bool limitPending = false;          // Asked to give up part of its range
+        Worker* stealingFrom = nullptr;     // Waiting for that worker's reply
+        int stealEnd = 0;                   // End of the range being taken over
+    };
+
+    std::string m_executable;
+    int m_workerCount;
+    std::vector<Worker> m_workers;
+    std::deque<std::pair<int, int>> m_queue;   // Frame ranges nobody works on
+    std::vector<char> m_finished;              // Per frame of the sequence
+    int m_firstFrame;
+    int m_finishedCount;
+
+    bool spawnWorker(Worker& worker, const std::vector<std::string>& arguments);
+    void assignWork(Worker& worker);
+    bool handleLine(Worker& worker, const std::string& line);
+    void closeWorker(Worker& worker);
+    static bool sendLine(int fd, const std::string& line);
+};
@@ -0,0 +1,49 @@
+#pragma once
+
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+class Timeline;
+
+// Chooses the render scale of each pass from a cost-per-pixel model. Measured GPU costs are
+// remembered per timeline slice (in Timeline's FPS data), which lets the controller lower
+// the scales before playback reaches a section that is known to be expensive.
+class RenderScaleController {
+public:
+    struct PassScale {
+        std::string name;
+        bool pinned = false;  // Always rendered at full scale
+        float scale = 1.0f;   // Current scale in, next frame's scale out
+    };
+
+    RenderScaleController();
+
+    // Record a GPU timing of a pass. pixelFraction is the fraction of the pass's
+    // width x height that was actually shaded. Returns the frame cost in ms per
+    // megapixel at full resolution, to be stored for the sample's timeline slice.
+    float addSample(const std::string& passName, float gpuMilliseconds, int width, int height, float pixelFraction);
+
+    // Divide budgetMs between the passes by their measured cost and update their scales
+    // for the next frame. Passes without measurements keep their current scale.
+    void predictPassScales(const Timeline& timeline, std::vector<PassScale>& passes, float budgetMs) const;
+
+    // Forget all measurements (e.g. when the project or shaders change)
+    void reset();
+
+private:
+    struct PassCost {
+        float fullResolutionMs = 0.0f; // Estimated cost of the pass at full resolution
+        float megapixels = 0.0f;       // Pass output size at full resolution
+    };
+    std::unordered_map<std::string, PassCost> m_passCosts;
+
+    float getCurrentCostPerMegapixel() const;
+    float getTotalMegapixels() const;
+    float getLookaheadCostFactor(const Timeline& timeline) const;
+
+    static constexpr float MIN_SCALE = 0.01f;
+    static constexpr float MAX_SCALE = 1.0f;
+    static constexpr float SCALE_UP_STEP = 0.05f;   // Maximum increase per frame
+    static constexpr float LOOKAHEAD_SECONDS = 0.5f; // Timeline seconds to look ahead while playing
+};
@@ -3,5 +3,6 @@
 enum class RenderScaleMode {
     Resolution,
     Chunk,
-    Auto
+    Auto,
+    Tiled
 };
@@ -0,0 +1,88 @@
+#pragma once
+
+#include <condition_variable>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <utility>
+
+#include "glad.h"
+
+struct GLFWwindow;
+class ShaderManager;
+
+// Renders passes on a dedicated thread with its own GL context that shares objects with
+// the UI context. Completed frames are handed over through three output textures
+// (triple buffering) synchronised with fences, so the UI never waits for a slow pass.
+class RenderThread {
+public:
+    // A job renders passes into the ShaderManager framebuffers and returns true if
+    // anything was drawn. It is executed with the ShaderManager mutex held.
+    using Job = std::function<bool()>;
+
+    struct Frame {
+        GLuint textureId = 0;
+        int width = 0;
+        int height = 0;
+        std::pair<float, float> uvScale = {1.0f, 1.0f};
+    };
+
+    explicit RenderThread(std::shared_ptr<ShaderManager> shaderManager);
+    ~RenderThread();
+
+    // Create the shared context and start the thread. Must be called on the main thread.
+    bool start(GLFWwindow* sharedWindow);
+
+    // Stop the thread and release its context. Must be called on the main thread.
+    void stop();
+
+    bool isRunning() const { return m_thread.joinable(); }
+
+    // Queue a job. A job that has not been started yet is replaced (latest wins).
+    void submit(Job job, const std::string& presentPass);
+
+    // Get the newest completed frame. Must be called with the UI context current.
+    Frame acquireLatestFrame();
+
+private:
+    struct Slot {
+        GLuint textureId = 0;
+        int width = 0;
+        int height = 0;
+        GLint format = 0;               // Internal format, follows the presented pass
+        std::pair<float, float> uvScale = {1.0f, 1.0f};
+        GLsync renderedFence = nullptr; // Signalled when the render thread finished writing
+        GLsync releasedFence = nullptr; // Signalled when the UI finished reading
+    };
+
+    std::shared_ptr<ShaderManager> m_shaderManager;
+    GLFWwindow* m_window;
+    std::thread m_thread;
+
+    // Job queue (single slot, latest wins)
+    std::mutex m_jobMutex;
+    std::condition_variable m_jobCondition;
+    Job m_pendingJob;
+    std::string m_pendingPresentPass;
+    bool m_hasJob;
+    bool m_stopRequested;
+
+    // Triple buffered output
+    Slot m_slots[3];
+    int m_writeIndex;    // Owned by the render thread
+    int m_readyIndex;    // Newest completed frame, exchanged under m_slotMutex
+    int m_displayIndex;  // Owned by the UI thread
+    bool m_readyIsNew;
+    std::mutex m_slotMutex;
+
+    // Render thread context objects
+    GLuint m_readFbo;
+    GLuint m_drawFbo;
+    std::string m_lastPresentedPass;
+
+    void threadMain();
+    bool copyToWriteSlot(GLuint sourceTexture, int width, int height);
+    void publishWriteSlot();
+};
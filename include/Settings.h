@@ -10,6 +10,16 @@ enum class DPIScaleMode {
     Disabled    // No scaling (1.0x)
 };
 
+enum class UpscaleFilter {
+    Bilinear,   // Sample the reduced region directly with bilinear filtering
+    Lanczos     // Lanczos-2 resample with anti-ringing to the full-size target
+};
+
+enum class ChunkMethod {
+    Stipple,    // Full-resolution draw that discards all fragments outside the phase
+    Scatter     // Draw the phase into a 1/stride sized target and scatter it into the frame
+};
+
 class Settings {
 public:
     // Get singleton instance
@@ -57,6 +67,42 @@ public:
     RenderScaleMode getRenderScaleMode() const { return m_renderScaleMode; }
     void setRenderScaleMode(RenderScaleMode mode);
 
+    // Target GPU frame time for the adaptive render scale (milliseconds)
+    float getFrameBudgetMs() const { return m_frameBudgetMs; }
+    void setFrameBudgetMs(float budgetMs);
+
+    // How chunk mode draws a phase (changing it reloads the shaders)
+    ChunkMethod getChunkMethod() const { return m_chunkMethod; }
+    void setChunkMethod(ChunkMethod method);
+
+    // Filter used to bring passes rendered at a reduced scale back to full size
+    UpscaleFilter getUpscaleFilter() const { return m_upscaleFilter; }
+    void setUpscaleFilter(UpscaleFilter filter);
+
+    // Size pass targets to the on-screen preview instead of the output resolution
+    bool getRenderAtPreviewSize() const { return m_renderAtPreviewSize; }
+    void setRenderAtPreviewSize(bool enabled);
+
+    // Render passes on a dedicated thread (takes effect on restart)
+    bool getRenderThreadEnabled() const { return m_renderThreadEnabled; }
+    void setRenderThreadEnabled(bool enabled);
+
+    // Time budget per UI frame for tiled rendering (milliseconds)
+    float getTileBudgetMs() const { return m_tileBudgetMs; }
+    void setTileBudgetMs(float budgetMs);
+
+    // Refresh changing tiles more often than static ones during tiled playback
+    bool getAdaptiveRefresh() const { return m_adaptiveRefresh; }
+    void setAdaptiveRefresh(bool enabled);
+
+    // Memory for compressed frames kept for timeline scrubbing (MB, 0 disables the cache)
+    int getFrameCacheMemoryMB() const { return m_frameCacheMemoryMB; }
+    void setFrameCacheMemoryMB(int megabytes);
+
+    // Thumbnail strip along the timeline, rendered in the background
+    bool getTimelineThumbnails() const { return m_timelineThumbnails; }
+    void setTimelineThumbnails(bool enabled);
+
     // Callback for when settings change
     std::function<void()> onSettingsChanged;
     // Callback for when render scale mode changes
@@ -81,6 +127,15 @@ private:
     float m_lowFPSRenderThreshold50 = 10.0f; // FPS below this will trigger 50% render scale
     float m_lowFPSRenderThreshold25 = 5.0f;  // FPS below this will trigger 25% render scale
     RenderScaleMode m_renderScaleMode = RenderScaleMode::Auto;
+    float m_frameBudgetMs = 20.0f; // 50 FPS
+    float m_tileBudgetMs = 8.0f; // GPU time spent on tiles per UI frame
+    bool m_adaptiveRefresh = false;
+    bool m_renderThreadEnabled = false;
+    UpscaleFilter m_upscaleFilter = UpscaleFilter::Lanczos;
+    ChunkMethod m_chunkMethod = ChunkMethod::Stipple;
+    bool m_renderAtPreviewSize = false;
+    int m_frameCacheMemoryMB = 256;
+    bool m_timelineThumbnails = true;
     
     // Cache detected DPI scale
     float m_detectedDPIScale = 1.0f;
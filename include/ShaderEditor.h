@@ -8,6 +8,13 @@
 #include <unordered_map>
 #include <deque>
 
+#include "RenderScaleMode.h"
+#include "FrameCache.h"
+#include "TimelineThumbnails.h"
+
+// Forward declare OpenGL types
+typedef unsigned int GLuint;
+
 // Forward declare ImGui types
 struct ImVec2;
 
@@ -20,8 +27,13 @@ class FileManager;
 class ParameterPanel;
 
 class Timeline;
+class RenderScaleController;
+class RenderThread;
+class FrameReadback;
+class SharedFrameOutput;
 class ShortcutManager;
 class ShaderProject;
+struct ShaderPass;
 
 class ShaderEditor {
 public:
@@ -53,12 +65,15 @@ public:
     // Get render scale factor
     float getRenderScaleFactor() const { return m_renderScaleFactor; }
 
-    // Set render scale factor
-    void setRenderScaleFactor(float factor) { m_renderScaleFactor = factor; }
+    // Set render scale factor (of all passes, until the controller adjusts them)
+    void setRenderScaleFactor(float factor) { m_renderScaleFactor = factor; m_passScaleFactors.clear(); }
 
     // Set screen size
     void setScreenSize(int width, int height);
 
+    // Move pass rendering to a dedicated thread (call with the UI context current)
+    void startRenderThread();
+
 private:
     std::shared_ptr<ShaderManager> m_shaderManager;
     std::shared_ptr<FileWatcher> m_fileWatcher;
@@ -71,7 +86,29 @@ private:
     std::shared_ptr<ParameterPanel> m_parameterPanel;
 
     std::unique_ptr<Timeline> m_timeline;
+    std::unique_ptr<RenderScaleController> m_scaleController;
+    std::unique_ptr<RenderThread> m_renderThread;
+    std::unique_ptr<FrameReadback> m_frameReadback;
     std::unique_ptr<ShortcutManager> m_shortcutManager;
+
+    // Optional live output of one pass for other processes
+    std::unique_ptr<SharedFrameOutput> m_sharedOutput;
+    std::unique_ptr<FrameReadback> m_sharedReadback;
+    std::string m_sharedOutputPass;
+
+    // Rendered frames of the previewed pass, shown at once when the timeline returns to
+    // their time. The texture holds the frame of the last lookup if it was a hit.
+    std::unique_ptr<FrameCache> m_frameCache;
+    std::unique_ptr<FrameReadback> m_frameCacheReadback;
+    FrameCache::Key m_frameCacheLookupKey;
+    bool m_frameCacheHit;
+    GLuint m_frameCacheTexture;
+    bool m_showingCachedFrame;
+
+    // Thumbnail strips of the previewed pass for the timeline. GPU time of the last
+    // measured frame of each pass, what is left of the frame budget goes to thumbnails.
+    std::unique_ptr<TimelineThumbnails> m_thumbnails;
+    std::unordered_map<std::string, float> m_passGpuMs;
     
     // Project management
     std::shared_ptr<ShaderProject> m_currentProject;
@@ -89,18 +126,52 @@ private:
     bool m_reloadProject;
     int m_screenWidth;
     int m_screenHeight;
-    float m_renderScaleFactor; // Current render scale factor (1.0, 0.5, 0.25)
+    float m_renderScaleFactor; // Lowest render scale factor of all passes
+    std::unordered_map<std::string, float> m_passScaleFactors; // Render scale per pass, chosen by m_scaleController
     std::unordered_map<std::string, std::pair<int, int>> m_passOutputSizes;
-    std::deque<float> m_fpsHistory;
-    int m_framesAboveHighThreshold;
-    int m_framesBelowLowThreshold;
-    
+
+    // Pass target size when rendering at the preview size. The preview size has to hold
+    // still for a few frames (or change a lot) before targets are reallocated.
+    std::pair<int, int> m_previewRenderSize;
+    std::pair<int, int> m_previewPendingSize;
+    int m_previewSettleFrames;
+
     // Thread-safe shader reload queue
     std::queue<std::string> m_pendingReloads;
     std::mutex m_reloadQueueMutex;
     
+    // Pass list snapshot handed to the renderer (possibly running on another thread)
+    struct PassRenderInfo {
+        std::string name;
+        int width;
+        int height;
+        float scale;
+    };
+
+    // Screenshots and dumps are rendered by the next render job into export targets at the
+    // output resolution. The queue is guarded by the ShaderManager mutex and kept out of the
+    // job, so a job replaced on the render thread before it started doesn't drop them.
+    struct ExportRequest {
+        std::string pass;
+        std::string path;
+        float time;
+        std::vector<PassRenderInfo> passes;
+    };
+    std::vector<ExportRequest> m_pendingExports;
+
     // Private methods
     void renderMainLayout();
+    std::vector<PassRenderInfo> collectPassRenderInfo(bool atOutputResolution) const;
+    std::pair<int, int> resolvePassSize(const ShaderPass& pass, bool previewSized, int depth) const;
+    void updatePreviewRenderSize();
+    RenderScaleMode getEffectiveRenderScaleMode() const;
+    bool renderPasses(const std::vector<PassRenderInfo>& passes, float time, RenderScaleMode scaleMode);
+    void processPassTimings(const std::vector<PassRenderInfo>& passes, RenderScaleMode scaleMode);
+    bool lookupCachedFrame(const FrameCache::Key& key);
+    void cacheRenderedFrame(const PassRenderInfo& pass, int slice, float quality);
+    void renderPendingExports();
+    void updateRenderScale();
+    float getPassScaleFactor(const std::string& passName) const;
     void onShaderCompiled(const std::string& name, bool success, const std::string& error);
     
     // Setup callbacks for component classes
@@ -112,7 +183,12 @@ public:
     void takeScreenshot();
     void openProject(const std::string& projectPath);
     void setupFileWatching();
+    // Queue a dump of the pass rendered at the output resolution (written a few frames later)
     void dumpFramebuffer(const std::string& passName, const std::string& outputPath);
+    // Wait for screenshots and dumps still being read back or written (before exiting)
+    void finishPendingWrites();
+    // Publish every rendered frame of the pass into a shared memory ring
+    bool setSharedOutput(const std::string& passName, const std::string& name);
     
 private:
     bool loadProjectFromPath(const std::string& projectPath);
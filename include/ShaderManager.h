@@ -6,6 +6,8 @@
 #include <functional>
 #include <vector>
 #include <map>
+#include <deque>
+#include <mutex>
 
 #include "ShaderPreprocessor.h"
 #include "RenderScaleMode.h"
@@ -15,6 +17,8 @@ typedef unsigned int GLuint;
 typedef unsigned int GLenum;
 
 #include "Framebuffer.h"
+#include "GpuTimer.h"
+#include "AdaptiveRefresh.h"
 
 class ShaderPreprocessor;
 
@@ -28,6 +32,43 @@ struct ShaderUniform {
     std::string group;
 };
 
+// Another pass a pass samples from
+struct ShaderPassInput {
+    std::string pass;
+    std::string output;   // Named output of the pass (ShaderPassOutput), empty for the first
+    bool mipmap = false;  // Expose the output with a mip chain (for textureLod)
+};
+
+// A colour attachment of a pass, written by fragment output location N for the Nth output
+struct ShaderPassOutput {
+    std::string name;
+    std::string format = "rgb8";  // rgb8, rgba8, r8, r16f, r32f, rg16f, rg32f, rgba16f, rgba32f
+};
+
+// A contact sheet of one pass: a grid of variants across the range of one or two uniform
+// components, everything else as in the preview
+struct UniformSweep {
+    struct Axis {
+        std::string uniform;    // Empty for no axis
+        int component = 0;      // Component of a vector uniform
+        float min = 0.0f;
+        float max = 1.0f;
+    };
+
+    std::string pass;
+    Axis x;
+    Axis y;                     // Without a y axis, x runs over all cells in reading order
+    int columns = 4;
+    int rows = 4;
+    int cellWidth = 160;
+    int cellHeight = 90;
+    float time = 0.0f;
+
+    // Values of the axes in a cell, counted row by row from the top left
+    float getX(int cell) const;
+    float getY(int cell) const;
+};
+
 class ShaderManager {
 public:
     struct ShaderProgram {
@@ -48,6 +89,7 @@ public:
         std::map<std::string, GLenum> systemUniformTypes;
         std::string lastError;
         bool isValid;
+        bool fragCoordMapped = true;    // False if the fragment shader redeclares gl_FragCoord
     };
 
     ShaderManager();
@@ -68,11 +110,59 @@ public:
     // Use shader program
     void useShader(const std::string& name);
     
-    // Render to framebuffer
-    void renderToFramebuffer(const std::string& name, int width, int height, float time, float renderScaleFactor, RenderScaleMode scaleMode);
+    // Render to framebuffer. Returns false if no draw was issued (converged chunk rendering)
+    bool renderToFramebuffer(const std::string& name, int width, int height, float time, float renderScaleFactor, RenderScaleMode scaleMode);
+
+    // Fraction of the framebuffer filled since the last input change (1.0 when complete)
+    float getRenderProgress(const std::string& name) const;
+
+    // Force chunk rendering of a pass to start over on the next frame
+    void invalidateRenderProgress(const std::string& name);
+
+    // Fingerprint of everything the image of a pass depends on except the time: the
+    // shader sources, uniforms, mouse and preview view of the pass and of its inputs.
+    // Sources are hashed rather than program ids, which are reused after a reload.
+    size_t computeFrameFingerprint(const std::string& name, int width, int height);
+
+    // Like computeFrameFingerprint, without the sizes and the preview view. Changes only
+    // when the sources or uniforms (or the mouse) of the pass or of its inputs change.
+    size_t computeSourceFingerprint(const std::string& name);
 
-    // Get texture ID of a framebuffer
-    GLuint getFramebufferTexture(const std::string& name);
+    // Render a pass at each of the times into its own small target, binding the program
+    // once for all of them. Inputs are read from the same sample of their last batch, and
+    // the preview state (render scale, fill progress, zoom) is neither used nor changed.
+    bool renderPassBatch(const std::string& name, int width, int height, const std::vector<float>& times);
+
+    // Copy the first output of a batch sample into a texture at x, y
+    void copyBatchOutput(const std::string& name, size_t sample, GLuint textureId, int x, int y);
+
+    // Render a pass in one draw into its own export target, for screenshots and dumps at
+    // the output resolution. Inputs are read from their export targets, and the preview
+    // state (target sizes, render scale, fill progress, zoom) is neither used nor changed.
+    bool renderPassExport(const std::string& name, int width, int height, float time);
+
+    // First output of the last export of a pass (0 if none)
+    GLuint getExportTexture(const std::string& name) const;
+
+    // Free the export targets once their textures have been read back
+    void releaseExportTargets();
+
+    // Render all cells of a sweep into one atlas target with a single program bind. Each
+    // cell gets its own viewport and scissor, and only the swept uniforms change between
+    // cells. Inputs are the passes' current framebuffers.
+    bool renderUniformSweep(const UniformSweep& sweep);
+
+    // Last rendered sweep and its atlas texture (0 if none), the top row of cells first
+    GLuint getUniformSweepTexture(UniformSweep& outSweep) const;
+
+    // Fetch the oldest finished GPU timing of a pass. Results lag a few frames behind.
+    bool pollPassTiming(const std::string& name, GpuTimer::Sample& outSample);
+
+    // Get texture ID of a framebuffer (the upscaled image when a pass was rendered at a reduced scale)
+    GLuint getFramebufferTexture(const std::string& name, int attachment = 0);
+
+    // Get the allocated size of a framebuffer ({0, 0} if it doesn't exist)
+    std::pair<int, int> getFramebufferSize(const std::string& name);
 
     // Get the UV scale of the framebuffer texture (useful when rendering a sub-region)
     std::pair<float, float> getFramebufferUVScale(const std::string& name);
@@ -87,6 +177,18 @@ public:
     void setMousePosition(float x, float y);
     void setMouseClickState(bool clicked);
     void updateIntegratedMouse(float dx, float dy);
+
+    // Zoomed preview: render the pass as the given sub-rectangle (normalized, origin at the
+    // bottom-left) of a larger virtual image. An empty pass name or the full rectangle resets it.
+    void setPreviewView(const std::string& passName, float x, float y, float width, float height);
+
+    // Passes a pass samples from, bound as iChannel0..N in order. Inputs must be rendered
+    // before the pass that reads them (ShaderProject checks the order). An input without
+    // a framebuffer is bound as texture 0.
+    void setPassInputs(const std::string& name, const std::vector<ShaderPassInput>& inputs);
+
+    // Colour attachments of a pass. The first one is the one displayed and dumped.
+    void setPassOutputs(const std::string& name, const std::vector<ShaderPassOutput>& outputs);
     
     // Get all shader names
     std::vector<std::string> getShaderNames() const;
@@ -113,6 +215,9 @@ public:
     void setSliderState(const std::string& name, int value);
     const std::unordered_map<std::string, int>& getSliderStates() const;
 
+    // Guards all shader and framebuffer state when passes are rendered on a separate thread
+    std::recursive_mutex& getMutex() { return m_mutex; }
+
 private:
     std::unordered_map<std::string, std::shared_ptr<ShaderProgram>> m_shaders;
     std::unordered_map<std::string, std::unique_ptr<Framebuffer>> m_framebuffers;
@@ -121,11 +226,90 @@ private:
     std::function<void(const std::string&, bool, const std::string&)> m_compilationCallback;
     GLuint m_quadVAO;
     GLuint m_quadVBO;
+    // Quad whose texture coordinates cover the visible region of the zoomed preview pass
+    GLuint m_viewQuadVAO;
+    GLuint m_viewQuadVBO;
     std::unordered_map<std::string, bool> m_errorLogged;
     std::unordered_map<std::string, bool> m_switchStates;
     std::unordered_map<std::string, int> m_sliderStates;
     float m_mouseUniform[4] = {0.0f, 0.0f, 0.0f, 0.0f};
     float m_mouseIntegrated[2] = {0.0f, 0.0f}; // Start at center
+
+    // Visible sub-rectangle of the zoomed preview pass
+    std::string m_viewPass;
+    float m_viewRect[4] = {0.0f, 0.0f, 1.0f, 1.0f};
+
+    // Progressive fill state for chunk rendering, tracked per pass
+    struct ChunkProgress {
+        size_t fingerprint = 0;
+        int totalPhases = 1;
+        int nextPhase = 0;
+        int phasesFilled = 0;
+    };
+    std::unordered_map<std::string, ChunkProgress> m_chunkProgress;
+
+    // Progressive tile state for tiled rendering, tracked per pass
+    struct TileProgress {
+        size_t fingerprint = 0;
+        float frameTime = 0.0f;  // Time captured when the frame's first tile was drawn
+        int nextTile = 0;
+        int tileCount = 0;
+        float avgTileMs = 0.0f;  // Running average of the cost of a single tile
+    };
+    std::unordered_map<std::string, TileProgress> m_tileProgress;
+
+    // Inputs of each pass (setPassInputs) and a counter of the draws issued per pass, so
+    // that a pass reading an input that is still filling in is not considered converged
+    std::unordered_map<std::string, std::vector<ShaderPassInput>> m_passInputs;
+    std::unordered_map<std::string, bool> m_missingInputLogged;   // "pass/input" warned about once
+    std::unordered_map<std::string, unsigned int> m_passGenerations;
+
+    // Attachments of passes with several outputs (setPassOutputs)
+    struct PassOutputs {
+        std::vector<std::string> names;
+        std::vector<GLenum> formats;
+    };
+    std::unordered_map<std::string, PassOutputs> m_passOutputs;
+
+    // Mip chains of pass outputs read with ShaderPassInput::mipmap, rebuilt once per new frame.
+    // Keyed by "pass.output".
+    struct InputMipmaps {
+        GLuint textureId = 0;
+        unsigned int generation = 0;
+    };
+    std::unordered_map<std::string, InputMipmaps> m_inputMipmaps;
+
+    // Change-driven tile scheduling of tiled passes (Settings::getAdaptiveRefresh)
+    std::unordered_map<std::string, std::unique_ptr<AdaptiveRefresh>> m_adaptiveRefresh;
+    std::vector<std::unique_ptr<AdaptiveRefresh>> m_retiredRefresh;
+
+    // GPU timer queries per pass and their collected results
+    std::unordered_map<std::string, std::unique_ptr<GpuTimer>> m_passTimers;
+    std::unordered_map<std::string, std::deque<GpuTimer::Sample>> m_passTimings;
+
+    // Framebuffers and queries are not shared between GL contexts, so they are only
+    // created and destroyed by the context that renders (see renderToFramebuffer)
+    std::vector<std::unique_ptr<Framebuffer>> m_retiredFramebuffers;
+
+    // Low resolution targets a chunk phase is drawn into before it is scattered (ChunkMethod::Scatter)
+    std::unordered_map<std::string, std::unique_ptr<Framebuffer>> m_scatterFramebuffers;
+
+    // Full-size targets holding the upscaled image of passes rendered at a reduced scale
+    std::unordered_map<std::string, std::unique_ptr<Framebuffer>> m_displayFramebuffers;
+    std::unordered_map<std::string, bool> m_displayValid;
+
+    // Small per-sample targets of renderPassBatch
+    std::unordered_map<std::string, std::vector<std::unique_ptr<Framebuffer>>> m_batchFramebuffers;
+
+    // Output-sized targets of renderPassExport, kept apart so the preview targets keep their size
+    std::unordered_map<std::string, std::unique_ptr<Framebuffer>> m_exportFramebuffers;
+
+    // Atlas of the last renderUniformSweep
+    std::unique_ptr<Framebuffer> m_sweepFramebuffer;
+    UniformSweep m_sweep;
+    std::vector<std::unique_ptr<GpuTimer>> m_retiredTimers;
+
+    std::recursive_mutex m_mutex;
     
     // Helper functions
     GLuint compileShader(const std::string& source, GLenum shaderType, std::string& outErrorLog, const std::vector<ShaderPreprocessor::LineMapping>* lineMappings = nullptr);
@@ -135,6 +319,19 @@ private:
     std::string getProgramInfoLog(GLuint program);
     void cleanupShader(ShaderProgram& shader);
     std::string remapErrorLog(const std::string& log, const std::vector<ShaderPreprocessor::LineMapping>* lineMappings) const;
+    size_t computeInputFingerprint(const std::string& name, int width, int height, float time, int stride);
+    size_t computeFrameFingerprint(const std::string& name, int width, int height, int depth, bool sized);
+    GLuint createQuadVAO(GLuint vbo);
+    void releaseRetiredResources();
+    std::vector<int> selectTiles(const std::string& name, float time);
+    void drawTiles(const std::vector<int>& tileList, int width, int height);
+    void drawPhaseTiles(std::vector<AdaptiveRefresh::Draw> draws, int width, int height);
+    void collectPassTimings(const std::string& name);
+    void bindPassInputs(const std::string& name, int batchSample = -1, bool exportInputs = false);
+    void applyPassUniforms(const std::string& name, float virtualWidth, float virtualHeight);
+    bool isPassInput(const std::string& name) const;
+    void updateInputMipmaps(const ShaderPassInput& input, GLuint textureId);
+    std::vector<GLenum> getPassFormats(const std::string& name) const;
     
     ShaderPreprocessor* m_preprocessor;
 
@@ -142,8 +339,36 @@ private:
     struct {
         GLuint programId;
         GLuint textureLocation;
+        GLuint sourceScaleLocation;
     } m_simpleTextureProgram;
 
+    struct {
+        GLuint programId;
+        GLuint textureLocation;
+        GLuint sourceSizeLocation;
+    } m_upscaleProgram;
+
+    struct {
+        GLuint programId;
+        GLuint textureLocation;
+        GLuint sourceSizeLocation;
+        GLuint strideLocation;
+        GLuint phaseOffsetLocation;
+        GLuint targetSizeLocation;
+    } m_scatterProgram;
+
+    // Tile change measurement of adaptive refresh
+    AdaptiveRefresh::ChangeProgram m_changeProgram;
+
     void setupSimpleTextureProgram();
+    void setupUpscaleProgram();
+    void setupScatterProgram();
+    void setupChangeProgram();
+    void scatterPhase(const std::string& name, int width, int height, int stride, int offsetX, int offsetY);
+    void drawUpscaled(GLuint sourceTexture, int sourceWidth, int sourceHeight, int textureWidth, int textureHeight);
+    void upscaleToDisplay(const std::string& name, int width, int height, int sourceWidth, int sourceHeight);
     void performUpscale(const std::string& name, int width, int height, float scaleX, float scaleY);
+
+    // Grow-only copy target for performUpscale, kept across mode switches
+    std::unique_ptr<Framebuffer> m_upscaleScratch;
 };
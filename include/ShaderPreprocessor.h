@@ -61,6 +61,7 @@ public:
         std::vector<LabelInfo> labels;
         std::vector<LineMapping> lineMappings;
         std::vector<GroupChange> groupChanges;
+        bool fragCoordMapped = false;   // gl_FragCoord follows u_view_scale/u_view_offset
     };
 
     // Callback for logging errors/warnings during preprocessing
@@ -22,11 +22,15 @@ struct ShaderPass {
     std::string name;
     std::string vertexShader;
     std::string fragmentShader;
-    std::vector<std::string> inputs;  // For multi-pass rendering
+    std::vector<ShaderPassInput> inputs;  // For multi-pass rendering
     std::string output;               // Output buffer name (optional)
+    std::vector<ShaderPassOutput> outputs;  // Colour attachments when the pass has several
     int width = 0;
     int height = 0;
+    float scale = 0.0f;               // Size relative to the output (or scaleRelativeTo), 0 = unset
+    std::string scaleRelativeTo;      // Pass whose size scale is relative to (optional)
     bool enabled = true;
+    bool pinScale = false;            // Never reduce the render scale of this pass
 };
 
 struct ShaderProjectManifest {
@@ -0,0 +1,105 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// Layout of the shared memory object, fixed-size fields only so consumers in other
+// languages can map it too. The region starts with the header, followed at headerSize by
+// slotCount slots of slotSize bytes, each a slot header followed by the pixels.
+//
+// Frames go into the slots round robin. A slot's sequence is 0 while it is being
+// written and the frame's sequence number once it is complete, so a reader checks that
+// the sequence is unchanged after reading the pixels (a sequence lock). Every published
+// frame increments frameSignal and wakes waiters with FUTEX_WAKE on it.
+struct SharedFrameHeader {
+    char magic[8];                          // "FORKEAT\0"
+    uint32_t version;                       // SHARED_FRAME_VERSION
+    uint32_t slotCount;
+    uint64_t slotSize;                      // Bytes per slot including its header
+    uint64_t headerSize;                    // Offset of the first slot
+    std::atomic<uint64_t> latestSequence;   // Newest complete frame, 0 before the first
+    std::atomic<uint32_t> frameSignal;      // Futex word
+    uint32_t reserved[9];
+};
+
+struct SharedFrameSlot {
+    std::atomic<uint64_t> sequence;         // 1, 2, 3, ... once complete, 0 while written
+    uint64_t timestampNs;                   // CLOCK_MONOTONIC when the frame was rendered
+    uint32_t format;                        // SHARED_FRAME_FORMAT_*
+    uint32_t width;
+    uint32_t height;
+    uint32_t stride;                        // Bytes per row
+    uint64_t size;                          // Bytes of pixel data
+    uint32_t reserved[6];
+};
+
+static const uint32_t SHARED_FRAME_VERSION = 1;
+static const uint32_t SHARED_FRAME_FORMAT_RGBA8 = 1;     // RGBA, bottom row first (GL order)
+
+static_assert(std::atomic<uint64_t>::is_always_lock_free, "Shared frame sequences need lock-free atomics");
+static_assert(sizeof(SharedFrameHeader) == 80, "Shared frame header layout changed");
+static_assert(sizeof(SharedFrameSlot) == 64, "Shared frame slot layout changed");
+
+// Publishes frames into a POSIX shared memory ring that other local processes map and
+// read at full rate, without files or encoding. Pages are only committed as they are
+// written, so a generous frame capacity costs address space, not memory.
+class SharedFrameOutput {
+public:
+    SharedFrameOutput();
+    ~SharedFrameOutput();
+
+    // Create (or replace) the shared memory object, "/name" or "name"
+    bool open(const std::string& name, int slotCount = 4, size_t maxFrameBytes = 4096 * 4096 * 4);
+
+    // Copy a frame into the next slot and wake waiting consumers. Frames larger than the
+    // capacity given to open() are dropped.
+    bool publish(const unsigned char* pixels, int width, int height, uint64_t timestampNs);
+
+    // Unmap and remove the object. Consumers that have it mapped keep their mapping.
+    void close();
+
+    bool isOpen() const { return m_header != nullptr; }
+    const std::string& getName() const { return m_name; }
+
+private:
+    std::string m_name;
+    SharedFrameHeader* m_header;
+    size_t m_mappedSize;
+    uint64_t m_sequence;
+    bool m_warnedTooLarge;
+
+    SharedFrameSlot* getSlot(uint64_t sequence) const;
+};
+
+// Consumer side of SharedFrameOutput, for tools and other processes linking this code
+class SharedFrameReader {
+public:
+    struct Frame {
+        uint64_t sequence = 0;
+        uint64_t timestampNs = 0;
+        uint32_t format = 0;
+        int width = 0;
+        int height = 0;
+        std::vector<unsigned char> pixels;
+    };
+
+    SharedFrameReader();
+    ~SharedFrameReader();
+
+    bool open(const std::string& name);
+    void close();
+
+    // Wait until a frame newer than the given sequence is published. Returns false on
+    // timeout (-1 waits forever).
+    bool waitForFrame(uint64_t afterSequence, int timeoutMs);
+
+    // Copy the newest frame. Fails if it was overwritten while being copied.
+    bool readLatest(Frame& frame) const;
+
+private:
+    SharedFrameHeader* m_header;
+    size_t m_mappedSize;
+};
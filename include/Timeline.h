@@ -1,6 +1,12 @@
 #include <functional>
+#include <utility>
 #include <vector>
 
+#include "TimelineThumbnails.h"
+
+// Forward declare ImGui types
+struct ImVec2;
+
 class Timeline {
 public:
     Timeline();
@@ -19,7 +25,7 @@ public:
     float getDuration() const { return m_duration; }
     
     // Set timeline duration
-    void setDuration(float duration) { m_duration = duration; }
+    void setDuration(float duration);
     
     // BPM support
     void setBPM(float bpm, int beatsPerBar = 4);
@@ -31,6 +37,9 @@ public:
     bool isPlaying() const { return m_isPlaying; }
     bool isLooping() const { return m_isLooping; }
     float getPlaybackSpeed() const { return m_playbackSpeed; }
+
+    // True while the time is dragged on the timeline bar
+    bool isScrubbing() const { return m_wasDragging; }
     
     // Update timeline (call every frame)
     void update(float deltaTime);
@@ -53,12 +62,21 @@ public:
     void pause();
     void stop();
     
-    // Add FPS value to buffer
-    void addFPS(float time, float fps, float renderScaleFactor);
+    // Add FPS value to buffer, optionally with the measured cost per megapixel at full resolution
+    void addFPS(float time, float fps, float renderScaleFactor, float costPerMegapixel = -1.0f);
+
+    // Measured cost in ms per megapixel for the slice containing time (-1 if unknown)
+    float getCostPerMegapixel(float time) const;
+
+    // Duration of one FPS data slice in seconds
+    float getTimeSliceDuration() const { return m_timeSliceDuration; }
 
     // Clear FPS data
     void clearFPSData();
 
+    // Thumbnails drawn along the timeline bar (an empty strip hides them)
+    void setThumbnails(TimelineThumbnailStrip strip) { m_thumbnails = std::move(strip); }
+
     // Callbacks for timeline events
     std::function<void(float)> onTimeChanged;
     std::function<void(bool)> onPlayStateChanged;
@@ -83,9 +101,12 @@ private:
     struct FPSData {
         float fps = -1.0f;
         float renderScaleFactor = 1.0f;
+        float costPerMegapixel = -1.0f;
     };
     std::vector<FPSData> m_fpsData;
     float m_timeSliceDuration;
+
+    TimelineThumbnailStrip m_thumbnails;
     
     // UI constants
     static constexpr float TIMELINE_HEIGHT = 70.0f;  // Increased by 5px
@@ -96,6 +117,7 @@ private:
     // Private methods
     void renderPlaybackControls();
     void renderTimelineBar(float renderScaleFactor);
+    void renderThumbnails(const ImVec2& stripStart, const ImVec2& stripEnd);
     void renderCurrentTime();
     void renderSpeedControl();
     void handlePlayPause();
@@ -0,0 +1,76 @@
+#pragma once
+
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+// Forward declare OpenGL types
+typedef unsigned int GLuint;
+
+class ShaderManager;
+class GpuTimer;
+
+// Thumbnails of one pass along the timeline, laid out row by row in one texture
+struct TimelineThumbnailStrip {
+    GLuint textureId = 0;
+    int columns = 0;
+    int rows = 0;
+    float aspect = 1.0f;        // Width over height of a thumbnail
+    std::vector<float> times;   // Timeline time of each thumbnail
+    std::vector<bool> ready;    // Rendered since the pass last changed
+};
+
+// Renders tiny frames of the previewed pass spread over the whole timeline, a few at a
+// time in whatever is left of the frame budget. All thumbnails of a batch are drawn with
+// one program bind per pass (ShaderManager::renderPassBatch). A strip is kept per pass
+// and only re-rendered once the sources or uniforms of that pass (or its inputs) change.
+class TimelineThumbnails {
+public:
+    struct Pass {
+        std::string name;
+        int width;
+        int height;
+    };
+
+    explicit TimelineThumbnails(std::shared_ptr<ShaderManager> shaderManager);
+    ~TimelineThumbnails();
+
+    // Render the next missing thumbnails of outputPass: one, or as many as the measured
+    // cost allows within availableMs. passes are the enabled passes in render order at
+    // their render size. Runs where the passes are rendered, with the ShaderManager mutex held.
+    void render(const std::vector<Pass>& passes, const std::string& outputPass, float duration, float availableMs);
+
+    // Thumbnails of a pass for drawing (no texture until the first batch)
+    TimelineThumbnailStrip getStrip(const std::string& passName) const;
+
+    // Drop all strips (e.g. when another project is loaded)
+    void clear();
+
+private:
+    struct Strip {
+        GLuint textureId = 0;
+        int width = 0;          // Size of one thumbnail
+        int height = 0;
+        float duration = 0.0f;
+        size_t fingerprint = 0; // ShaderManager::computeSourceFingerprint
+        std::vector<bool> ready;
+        int readyCount = 0;
+    };
+
+    std::shared_ptr<ShaderManager> m_shaderManager;
+    std::unordered_map<std::string, Strip> m_strips;
+
+    // Thumbnail indices coarse to fine, so the whole timeline is covered early
+    std::vector<int> m_fillOrder;
+
+    // Measures batches in the rendering context, the tile count of a sample is the
+    // number of thumbnails in the batch
+    std::unique_ptr<GpuTimer> m_timer;
+    float m_thumbnailMs;    // Running average of the cost of one thumbnail
+
+    static constexpr int THUMBNAIL_COUNT = 64;
+    static constexpr int COLUMNS = 8;
+    static constexpr int THUMBNAIL_HEIGHT = 48;
+    static constexpr int MAX_BATCH = 8;
+};
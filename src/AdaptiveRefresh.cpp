@@ -0,0 +1,238 @@
+#include "AdaptiveRefresh.h"
+#include <algorithm>
+#include <cmath>
+
+// Urgency of a tile phase that has not been rendered since the last invalidate()
+static const float INVALID_PRIORITY = 1e9f;
+
+// Change rate every tile is assumed to have at least, so static tiles are still refreshed
+static const float STATIC_CHANGE_RATE = 0.02f;
+
+AdaptiveRefresh::AdaptiveRefresh()
+    : m_width(0)
+    , m_height(0)
+    , m_tileSize(1)
+    , m_columns(0)
+    , m_rows(0)
+    , m_stride(1)
+    , m_format(GL_RGB8) {
+}
+
+AdaptiveRefresh::~AdaptiveRefresh() {
+    releaseReadback();
+    if (m_readback.buffer != 0) {
+        glDeleteBuffers(1, &m_readback.buffer);
+    }
+}
+
+void AdaptiveRefresh::resize(int width, int height, int tileSize, GLenum format, int stride) {
+    stride = std::max(1, stride);
+    if (width == m_width && height == m_height && tileSize == m_tileSize && format == m_format && stride == m_stride) {
+        return;
+    }
+
+    m_width = width;
+    m_height = height;
+    m_format = format;
+    m_stride = stride;
+    m_tileSize = std::max(1, tileSize);
+    m_columns = (width + m_tileSize - 1) / m_tileSize;
+    m_rows = (height + m_tileSize - 1) / m_tileSize;
+    m_tiles.assign(m_columns * m_rows, Tile());
+    m_cells.assign(m_tiles.size() * stride * stride, Cell());
+    m_selected.clear();
+
+    releaseReadback();
+    m_history.reset();
+    m_changes.reset();
+}
+
+void AdaptiveRefresh::invalidate() {
+    for (auto& cell : m_cells) {
+        cell.valid = false;
+    }
+}
+
+std::vector<AdaptiveRefresh::Draw> AdaptiveRefresh::selectTiles(float time, int maxDraws) {
+    int tileCount = static_cast<int>(m_tiles.size());
+    std::vector<int> candidates;
+    for (int i = 0; i < static_cast<int>(m_cells.size()); i++) {
+        Cell& cell = m_cells[i];
+        if (cell.valid && cell.time == time) {
+            continue;
+        }
+        if (!cell.valid) {
+            cell.priority = INVALID_PRIORITY;
+        } else {
+            cell.priority += m_tiles[i % tileCount].changeRate + STATIC_CHANGE_RATE;
+        }
+        candidates.push_back(i);
+    }
+
+    int count = std::min(maxDraws, static_cast<int>(candidates.size()));
+    std::partial_sort(candidates.begin(), candidates.begin() + count, candidates.end(), [this](int a, int b) {
+        if (m_cells[a].priority != m_cells[b].priority) {
+            return m_cells[a].priority > m_cells[b].priority;
+        }
+        return a < b;
+    });
+    candidates.resize(count);
+
+    // A tile's change is measured on one of its redrawn phases, preferably one with an
+    // earlier render to compare against
+    std::vector<Draw> draws;
+    std::vector<bool> selected(tileCount, false);
+    m_selected.clear();
+    for (int index : candidates) {
+        Draw draw{ index % tileCount, index / tileCount };
+        Cell& cell = m_cells[index];
+        Tile& tile = m_tiles[draw.tile];
+        float delta = cell.valid ? std::abs(time - cell.time) : 0.0f;
+        if (!selected[draw.tile]) {
+            selected[draw.tile] = true;
+            m_selected.push_back(draw.tile);
+            tile.measuredPhase = draw.phase;
+            tile.pendingDelta = delta;
+        } else if (tile.pendingDelta <= 0.0f && delta > 0.0f) {
+            tile.measuredPhase = draw.phase;
+            tile.pendingDelta = delta;
+        }
+        cell.time = time;
+        cell.valid = true;
+        cell.priority = 0.0f;
+        draws.push_back(draw);
+    }
+    return draws;
+}
+
+void AdaptiveRefresh::getTileRect(int tile, int& x, int& y, int& width, int& height) const {
+    x = (tile % m_columns) * m_tileSize;
+    y = (tile / m_columns) * m_tileSize;
+    width = std::min(m_tileSize, m_width - x);
+    height = std::min(m_tileSize, m_height - y);
+}
+
+void AdaptiveRefresh::beginTiles(GLuint framebuffer) {
+    if (!m_history) {
+        // Same format as the pass, blits can't convert between float and normalized formats
+        m_history = std::make_unique<Framebuffer>(m_width, m_height, std::vector<GLenum>{m_format});
+    }
+
+    glBindFramebuffer(GL_READ_FRAMEBUFFER, framebuffer);
+    glBindFramebuffer(GL_DRAW_FRAMEBUFFER, m_history->getFramebufferId());
+    for (int tile : m_selected) {
+        int x, y, width, height;
+        getTileRect(tile, x, y, width, height);
+        glBlitFramebuffer(x, y, x + width, y + height, x, y, x + width, y + height, GL_COLOR_BUFFER_BIT, GL_NEAREST);
+    }
+    glBindFramebuffer(GL_FRAMEBUFFER, framebuffer);
+}
+
+void AdaptiveRefresh::measureTiles(GLuint framebufferTexture, const ChangeProgram& program) {
+    // Only one readback is in flight at a time, tiles drawn meanwhile keep their estimate
+    if (m_readback.fence || !m_history || program.programId == 0) {
+        return;
+    }
+
+    std::vector<int> measured;
+    std::vector<float> deltas;
+    for (int index : m_selected) {
+        // Nothing to compare against when the phase was (re)drawn at the same time
+        if (m_tiles[index].pendingDelta > 0.0f) {
+            measured.push_back(index);
+            deltas.push_back(m_tiles[index].pendingDelta);
+        }
+    }
+    if (measured.empty()) {
+        return;
+    }
+
+    if (!m_changes) {
+        m_changes = std::make_unique<Framebuffer>(m_columns, m_rows);
+    }
+
+    m_changes->bind();
+    glUseProgram(program.programId);
+    glActiveTexture(GL_TEXTURE1);
+    glBindTexture(GL_TEXTURE_2D, m_history->getTextureId());
+    glActiveTexture(GL_TEXTURE0);
+    glBindTexture(GL_TEXTURE_2D, framebufferTexture);
+    glUniform1i(program.currentLocation, 0);
+    glUniform1i(program.previousLocation, 1);
+
+    for (int index : measured) {
+        int x, y, width, height;
+        getTileRect(index, x, y, width, height);
+        int phase = m_tiles[index].measuredPhase;
+        glUniform4i(program.tileRectLocation, x, y, width, height);
+        glUniform3i(program.phaseLocation, m_stride, phase % m_stride, phase / m_stride);
+        glViewport(index % m_columns, index / m_columns, 1, 1);
+        glDrawArrays(GL_TRIANGLES, 0, 3);
+    }
+
+    // Read the whole (tiny) change texture back without waiting for it
+    if (m_readback.buffer == 0) {
+        glGenBuffers(1, &m_readback.buffer);
+    }
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, m_readback.buffer);
+    glBufferData(GL_PIXEL_PACK_BUFFER, m_columns * m_rows * 3, nullptr, GL_STREAM_READ);
+    glPixelStorei(GL_PACK_ALIGNMENT, 1);
+    glReadPixels(0, 0, m_columns, m_rows, GL_RGB, GL_UNSIGNED_BYTE, nullptr);
+    glPixelStorei(GL_PACK_ALIGNMENT, 4);
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+
+    m_readback.fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+    m_readback.tiles = std::move(measured);
+    m_readback.deltas = std::move(deltas);
+}
+
+void AdaptiveRefresh::poll() {
+    if (!m_readback.fence) {
+        return;
+    }
+
+    GLenum status = glClientWaitSync(m_readback.fence, 0, 0);
+    if (status != GL_ALREADY_SIGNALED && status != GL_CONDITION_SATISFIED) {
+        return;
+    }
+
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, m_readback.buffer);
+    const unsigned char* data = static_cast<const unsigned char*>(
+        glMapBufferRange(GL_PIXEL_PACK_BUFFER, 0, m_columns * m_rows * 3, GL_MAP_READ_BIT));
+    if (data) {
+        for (size_t i = 0; i < m_readback.tiles.size(); i++) {
+            int index = m_readback.tiles[i];
+            // The shader stores the square root of the mean difference for precision
+            float encoded = data[index * 3] / 255.0f;
+            float rate = encoded * encoded / m_readback.deltas[i];
+            Tile& tile = m_tiles[index];
+            tile.changeRate = tile.changeRate * 0.5f + rate * 0.5f;
+        }
+        glUnmapBuffer(GL_PIXEL_PACK_BUFFER);
+    }
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+
+    releaseReadback();
+}
+
+float AdaptiveRefresh::getProgress(float time) const {
+    if (m_cells.empty()) {
+        return 1.0f;
+    }
+    int current = 0;
+    for (const auto& cell : m_cells) {
+        if (cell.valid && cell.time == time) {
+            current++;
+        }
+    }
+    return static_cast<float>(current) / static_cast<float>(m_cells.size());
+}
+
+void AdaptiveRefresh::releaseReadback() {
+    if (m_readback.fence) {
+        glDeleteSync(m_readback.fence);
+        m_readback.fence = nullptr;
+    }
+    m_readback.tiles.clear();
+    m_readback.deltas.clear();
+}
@@ -0,0 +1,221 @@
+#include "FrameCache.h"
+#include "Logger.h"
+#include <algorithm>
+#include <iterator>
+#include <utility>
+
+#include <zlib.h>
+
+// Frames waiting to be compressed. Further frames are dropped, caching is opportunistic.
+static const size_t MAX_PENDING_FRAMES = 2;
+
+// Bytes per pixel of the cached frames (RGBA8)
+static const int FRAME_CHANNELS = 4;
+
+FrameCache::FrameCache(size_t budgetBytes)
+    : m_memoryBytes(0)
+    , m_budgetBytes(budgetBytes)
+    , m_hits(0)
+    , m_misses(0)
+    , m_nextTag(1)
+    , m_stopRequested(false) {
+    m_worker = std::thread(&FrameCache::workerMain, this);
+}
+
+FrameCache::~FrameCache() {
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_stopRequested = true;
+    }
+    m_workCondition.notify_all();
+    m_worker.join();
+}
+
+void FrameCache::setBudget(size_t budgetBytes) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_budgetBytes = budgetBytes;
+    evict();
+}
+
+bool FrameCache::isEnabled() const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_budgetBytes > 0;
+}
+
+bool FrameCache::wants(const Key& key, float quality) const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if (m_budgetBytes == 0 || m_pending.size() >= MAX_PENDING_FRAMES) {
+        return false;
+    }
+    for (const auto& reserved : m_reserved) {
+        if (reserved.second.first == key && reserved.second.second >= quality) {
+            return false;
+        }
+    }
+    auto it = m_index.find(key);
+    return it == m_index.end() || it->second->quality < quality;
+}
+
+uint64_t FrameCache::reserve(const Key& key, float quality) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    uint64_t tag = m_nextTag++;
+    m_reserved[tag] = { key, quality };
+    return tag;
+}
+
+void FrameCache::store(uint64_t tag, int width, int height, const unsigned char* pixels) {
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        auto it = m_reserved.find(tag);
+        if (it == m_reserved.end()) {
+            return;
+        }
+        PendingFrame frame;
+        frame.key = it->second.first;
+        frame.quality = it->second.second;
+        m_reserved.erase(m_reserved.begin(), std::next(it));
+        if (m_budgetBytes == 0 || m_pending.size() >= MAX_PENDING_FRAMES || width <= 0 || height <= 0) {
+            return;
+        }
+        frame.width = width;
+        frame.height = height;
+        frame.pixels.assign(pixels, pixels + static_cast<size_t>(width) * height * FRAME_CHANNELS);
+        m_pending.push_back(std::move(frame));
+    }
+    m_workCondition.notify_one();
+}
+
+bool FrameCache::lookup(const Key& key, int& width, int& height, std::vector<unsigned char>& pixels) {
+    Entry entry;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        auto it = m_index.find(key);
+        if (it == m_index.end()) {
+            m_misses++;
+            return false;
+        }
+        m_hits++;
+        m_entries.splice(m_entries.begin(), m_entries, it->second);
+        entry.width = it->second->width;
+        entry.height = it->second->height;
+        entry.data = it->second->data;
+    }
+
+    // Decompressed outside the lock, the worker keeps storing meanwhile
+    size_t rowBytes = static_cast<size_t>(entry.width) * FRAME_CHANNELS;
+    pixels.resize(rowBytes * entry.height);
+    uLongf size = static_cast<uLongf>(pixels.size());
+    if (uncompress(pixels.data(), &size, entry.data.data(), static_cast<uLong>(entry.data.size())) != Z_OK
+        || size != pixels.size()) {
+        LOG_ERROR("Failed to decompress cached frame of {}", key.pass);
+        return false;
+    }
+
+    // Undo the delta coding, each byte was stored relative to the same channel of the
+    // pixel to its left
+    for (int y = 0; y < entry.height; y++) {
+        unsigned char* row = pixels.data() + rowBytes * y;
+        for (size_t i = FRAME_CHANNELS; i < rowBytes; i++) {
+            row[i] = static_cast<unsigned char>(row[i] + row[i - FRAME_CHANNELS]);
+        }
+    }
+
+    width = entry.width;
+    height = entry.height;
+    return true;
+}
+
+void FrameCache::clear() {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_entries.clear();
+    m_index.clear();
+    m_reserved.clear();
+    m_pending.clear();
+    m_memoryBytes = 0;
+    m_hits = 0;
+    m_misses = 0;
+}
+
+FrameCache::Stats FrameCache::getStats() const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    Stats stats;
+    stats.frames = m_entries.size();
+    stats.memoryBytes = m_memoryBytes;
+    stats.budgetBytes = m_budgetBytes;
+    stats.hits = m_hits;
+    stats.misses = m_misses;
+    return stats;
+}
+
+void FrameCache::workerMain() {
+    std::vector<unsigned char> compressed;
+    while (true) {
+        PendingFrame frame;
+        {
+            std::unique_lock<std::mutex> lock(m_mutex);
+            m_workCondition.wait(lock, [this]() { return m_stopRequested || !m_pending.empty(); });
+            if (m_stopRequested) {
+                return;
+            }
+            frame = std::move(m_pending.front());
+            m_pending.pop_front();
+        }
+
+        // Rendered images are mostly smooth, so neighbouring pixels are stored as differences
+        // (like the PNG sub filter) which the fastest deflate level then packs well
+        size_t rowBytes = static_cast<size_t>(frame.width) * FRAME_CHANNELS;
+        for (int y = 0; y < frame.height; y++) {
+            unsigned char* row = frame.pixels.data() + rowBytes * y;
+            for (size_t i = rowBytes; i-- > FRAME_CHANNELS;) {
+                row[i] = static_cast<unsigned char>(row[i] - row[i - FRAME_CHANNELS]);
+            }
+        }
+
+        uLongf size = compressBound(static_cast<uLong>(frame.pixels.size()));
+        compressed.resize(size);
+        if (compress2(compressed.data(), &size, frame.pixels.data(), static_cast<uLong>(frame.pixels.size()),
+                      Z_BEST_SPEED) != Z_OK) {
+            LOG_ERROR("Failed to compress frame of {} for the cache", frame.key.pass);
+            continue;
+        }
+
+        Entry entry;
+        entry.key = frame.key;
+        entry.quality = frame.quality;
+        entry.width = frame.width;
+        entry.height = frame.height;
+        entry.data.assign(compressed.begin(), compressed.begin() + size);
+
+        std::lock_guard<std::mutex> lock(m_mutex);
+        insert(std::move(entry));
+    }
+}
+
+void FrameCache::insert(Entry entry) {
+    auto it = m_index.find(entry.key);
+    if (it != m_index.end()) {
+        if (it->second->quality >= entry.quality) {
+            return;
+        }
+        m_memoryBytes -= it->second->data.size();
+        m_entries.erase(it->second);
+        m_index.erase(it);
+    }
+    if (entry.data.size() > m_budgetBytes) {
+        return;
+    }
+
+    m_memoryBytes += entry.data.size();
+    Key key = entry.key;
+    m_entries.push_front(std::move(entry));
+    m_index[key] = m_entries.begin();
+    evict();
+}
+
+void FrameCache::evict() {
+    while (m_memoryBytes > m_budgetBytes && !m_entries.empty()) {
+        m_memoryBytes -= m_entries.back().data.size();
+        m_index.erase(m_entries.back().key);
+        m_entries.pop_back();
+    }
+}
@@ -0,0 +1,276 @@
+#include "FrameEncoder.h"
+#include "Logger.h"
+#include <algorithm>
+#include <cmath>
+#include <csignal>
+#include <filesystem>
+
+#define STB_IMAGE_WRITE_IMPLEMENTATION
+#include "stb_image_write.h"
+
+// Frames queued or being encoded per worker before submit() applies backpressure
+static const int FRAMES_PER_WORKER = 2;
+
+FrameEncoder::FrameEncoder(int threadCount)
+    : m_nextSequence(0)
+    , m_nextWrite(0)
+    , m_inProgress(0)
+    , m_failedWrites(0)
+    , m_stopRequested(false)
+    , m_format(Format::Png)
+    , m_stream(nullptr)
+    , m_ownsStream(false)
+    , m_fps(60.0f)
+    , m_headerWritten(false)
+    , m_streamWidth(0)
+    , m_streamHeight(0) {
+    if (threadCount <= 0) {
+        threadCount = std::max(1, static_cast<int>(std::thread::hardware_concurrency()));
+    }
+    for (int i = 0; i < threadCount; i++) {
+        m_workers.emplace_back(&FrameEncoder::workerMain, this);
+    }
+}
+
+FrameEncoder::~FrameEncoder() {
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_stopRequested = true;
+    }
+    m_workCondition.notify_all();
+    for (auto& worker : m_workers) {
+        worker.join();
+    }
+    closeStream();
+}
+
+bool FrameEncoder::parseFormat(const std::string& name, Format& format) {
+    if (name == "png") {
+        format = Format::Png;
+    } else if (name == "y4m") {
+        format = Format::Y4m;
+    } else if (name == "rgba") {
+        format = Format::RawRgba;
+    } else {
+        return false;
+    }
+    return true;
+}
+
+bool FrameEncoder::openStream(const std::string& path, Format format, float fps) {
+    finish();
+    closeStream();
+
+    m_format = format;
+    m_fps = fps;
+    m_headerWritten = false;
+    if (format == Format::Png) {
+        return true;
+    }
+
+    // A reader that goes away must fail the write, not terminate the process
+    std::signal(SIGPIPE, SIG_IGN);
+
+    if (path == "-") {
+        m_stream = stdout;
+        m_ownsStream = false;
+    } else {
+        // Opening a named pipe blocks until the reader (e.g. ffmpeg) has opened it
+        m_stream = std::fopen(path.c_str(), "wb");
+        m_ownsStream = true;
+        if (!m_stream) {
+            LOG_ERROR("Failed to open {} for streaming", path);
+            return false;
+        }
+    }
+    LOG_INFO("Streaming frames to {}", path == "-" ? std::string("stdout") : path);
+    return true;
+}
+
+void FrameEncoder::closeStream() {
+    if (m_stream) {
+        std::fflush(m_stream);
+        if (m_ownsStream) {
+            std::fclose(m_stream);
+        }
+        m_stream = nullptr;
+    }
+}
+
+void FrameEncoder::submit(Frame frame) {
+    std::unique_lock<std::mutex> lock(m_mutex);
+    int maxInFlight = static_cast<int>(m_workers.size()) * FRAMES_PER_WORKER;
+    m_writeCondition.wait(lock, [this, maxInFlight]() {
+        return static_cast<int>(m_queue.size()) + m_inProgress < maxInFlight;
+    });
+
+    Job job;
+    job.sequence = m_nextSequence++;
+    job.frame = std::move(frame);
+    m_queue.push_back(std::move(job));
+    lock.unlock();
+    m_workCondition.notify_one();
+}
+
+void FrameEncoder::finish() {
+    std::unique_lock<std::mutex> lock(m_mutex);
+    m_writeCondition.wait(lock, [this]() { return m_nextWrite == m_nextSequence; });
+    if (m_stream) {
+        std::fflush(m_stream);
+    }
+}
+
+int FrameEncoder::getFailedWrites() const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_failedWrites;
+}
+
+void FrameEncoder::workerMain() {
+    std::unique_lock<std::mutex> lock(m_mutex);
+    while (true) {
+        m_workCondition.wait(lock, [this]() { return m_stopRequested || !m_queue.empty(); });
+        if (m_queue.empty()) {
+            return;
+        }
+
+        Job job = std::move(m_queue.front());
+        m_queue.pop_front();
+        m_inProgress++;
+        lock.unlock();
+
+        // Encoding runs in parallel, only the writes are serialised
+        std::vector<unsigned char> data = encode(job.frame);
+
+        lock.lock();
+        m_writeCondition.wait(lock, [this, &job]() { return m_nextWrite == job.sequence; });
+        lock.unlock();
+
+        bool written = write(job.frame, data);
+
+        lock.lock();
+        if (!written) {
+            m_failedWrites++;
+        }
+        m_inProgress--;
+        m_nextWrite++;
+        m_writeCondition.notify_all();
+    }
+}
+
+std::vector<unsigned char> FrameEncoder::encode(const Frame& frame) const {
+    const int width = frame.width;
+    const int height = frame.height;
+    auto sourceRow = [&frame, width, height](int y) {
+        // Read back frames are bottom row first, every output is top row first
+        return frame.pixels.data() + static_cast<size_t>(height - 1 - y) * width * 4;
+    };
+
+    std::vector<unsigned char> data;
+    if (m_format == Format::Png) {
+        std::vector<unsigned char> rgb(static_cast<size_t>(width) * height * 3);
+        for (int y = 0; y < height; y++) {
+            const unsigned char* source = sourceRow(y);
+            unsigned char* target = rgb.data() + static_cast<size_t>(y) * width * 3;
+            for (int x = 0; x < width; x++) {
+                target[x * 3] = source[x * 4];
+                target[x * 3 + 1] = source[x * 4 + 1];
+                target[x * 3 + 2] = source[x * 4 + 2];
+            }
+        }
+        stbi_write_png_to_func([](void* context, void* bytes, int size) {
+            auto* output = static_cast<std::vector<unsigned char>*>(context);
+            const unsigned char* begin = static_cast<const unsigned char*>(bytes);
+            output->insert(output->end(), begin, begin + size);
+        }, &data, width, height, 3, rgb.data(), width * 3);
+    } else if (m_format == Format::Y4m) {
+        // Planar Y, Cb, Cr at full resolution with the integer BT.601 studio swing matrix
+        const size_t planeSize = static_cast<size_t>(width) * height;
+        data.resize(planeSize * 3);
+        unsigned char* planeY = data.data();
+        unsigned char* planeU = planeY + planeSize;
+        unsigned char* planeV = planeU + planeSize;
+        for (int y = 0; y < height; y++) {
+            const unsigned char* source = sourceRow(y);
+            size_t offset = static_cast<size_t>(y) * width;
+            for (int x = 0; x < width; x++) {
+                int r = source[x * 4];
+                int g = source[x * 4 + 1];
+                int b = source[x * 4 + 2];
+                planeY[offset + x] = static_cast<unsigned char>(((66 * r + 129 * g + 25 * b + 128) >> 8) + 16);
+                planeU[offset + x] = static_cast<unsigned char>(((-38 * r - 74 * g + 112 * b + 128) >> 8) + 128);
+                planeV[offset + x] = static_cast<unsigned char>(((112 * r - 94 * g - 18 * b + 128) >> 8) + 128);
+            }
+        }
+    } else {
+        data.resize(static_cast<size_t>(width) * height * 4);
+        for (int y = 0; y < height; y++) {
+            std::copy(sourceRow(y), sourceRow(y) + width * 4, data.data() + static_cast<size_t>(y) * width * 4);
+        }
+    }
+    return data;
+}
+
+bool FrameEncoder::write(const Frame& frame, const std::vector<unsigned char>& data) {
+    if (m_format == Format::Png) {
+        if (data.empty()) {
+            LOG_ERROR("Failed to encode {}", frame.path);
+            return false;
+        }
+
+        // Written under a temporary name and renamed, so readers (and resumed sequence
+        // renders) never see a truncated file
+        std::string temporaryPath = frame.path + ".part";
+        std::FILE* file = std::fopen(temporaryPath.c_str(), "wb");
+        bool written = file && std::fwrite(data.data(), 1, data.size(), file) == data.size();
+        if (file && std::fclose(file) != 0) {
+            written = false;
+        }
+        if (!written) {
+            LOG_ERROR("Failed to write {}", frame.path);
+            return false;
+        }
+
+        std::error_code error;
+        std::filesystem::rename(temporaryPath, frame.path, error);
+        if (error) {
+            LOG_ERROR("Failed to rename {} to {}: {}", temporaryPath, frame.path, error.message());
+            return false;
+        }
+        LOG_DEBUG("Wrote {}x{} frame to {}", frame.width, frame.height, frame.path);
+        return true;
+    }
+
+    if (!m_stream) {
+        return false;
+    }
+    if (!m_headerWritten) {
+        m_streamWidth = frame.width;
+        m_streamHeight = frame.height;
+        if (m_format == Format::Y4m) {
+            // Whole frame rates as n:1, others (29.97) with three decimals
+            int numerator = static_cast<int>(std::lround(m_fps * 1000.0f));
+            int denominator = 1000;
+            if (numerator % 1000 == 0) {
+                numerator /= 1000;
+                denominator = 1;
+            }
+            std::fprintf(m_stream, "YUV4MPEG2 W%d H%d F%d:%d Ip A1:1 C444\n",
+                         frame.width, frame.height, numerator, denominator);
+        }
+        m_headerWritten = true;
+    }
+    if (frame.width != m_streamWidth || frame.height != m_streamHeight) {
+        LOG_ERROR("Frame size changed from {}x{} to {}x{} in the middle of a stream",
+                  m_streamWidth, m_streamHeight, frame.width, frame.height);
+        return false;
+    }
+
+    if (m_format == Format::Y4m) {
+        std::fputs("FRAME\n", m_stream);
+    }
+    if (std::fwrite(data.data(), 1, data.size(), m_stream) != data.size()) {
+        LOG_ERROR("Failed to write frame to the stream, the reader may have closed it");
+        return false;
+    }
+    return true;
+}
@@ -0,0 +1,174 @@
+#include "FrameReadback.h"
+#include "FrameEncoder.h"
+#include "Logger.h"
+#include <algorithm>
+#include <cstring>
+#include <utility>
+
+FrameReadback::FrameReadback(std::shared_ptr<FrameEncoder> encoder, int ringSize)
+    : m_slots(std::max(1, ringSize))
+    , m_head(0)
+    , m_pending(0)
+    , m_encoder(encoder ? encoder : std::make_shared<FrameEncoder>())
+    , m_failedReads(0) {
+}
+
+FrameReadback::FrameReadback(Consumer consumer, int ringSize)
+    : m_slots(std::max(1, ringSize))
+    , m_head(0)
+    , m_pending(0)
+    , m_consumer(std::move(consumer))
+    , m_failedReads(0) {
+}
+
+FrameReadback::~FrameReadback() {
+}
+
+void FrameReadback::request(GLuint textureId, const std::string& path, uint64_t tag) {
+    std::lock_guard<std::mutex> lock(m_slotMutex);
+
+    Slot& slot = m_slots[m_head];
+    if (slot.fence) {
+        // The whole ring is in flight, the oldest read has to finish first
+        collect(slot, true);
+        m_pending--;
+    }
+
+    glBindTexture(GL_TEXTURE_2D, textureId);
+    glGetTexLevelParameteriv(GL_TEXTURE_2D, 0, GL_TEXTURE_WIDTH, &slot.width);
+    glGetTexLevelParameteriv(GL_TEXTURE_2D, 0, GL_TEXTURE_HEIGHT, &slot.height);
+    if (slot.width <= 0 || slot.height <= 0) {
+        LOG_ERROR("Cannot read back texture {} for {}", textureId, path);
+        return;
+    }
+
+    // RGBA8 rows are always 4-byte aligned and match the native layout, so the copy
+    // into the buffer is a plain DMA transfer without a conversion on the CPU
+    GLsizeiptr size = static_cast<GLsizeiptr>(slot.width) * slot.height * 4;
+    if (slot.buffer == 0) {
+        glGenBuffers(1, &slot.buffer);
+    }
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, slot.buffer);
+    if (slot.capacity != size) {
+        glBufferData(GL_PIXEL_PACK_BUFFER, size, nullptr, GL_STREAM_READ);
+        slot.capacity = size;
+    }
+    glGetTexImage(GL_TEXTURE_2D, 0, GL_RGBA, GL_UNSIGNED_BYTE, nullptr);
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+
+    // Flushed so the fence can be waited on from the other shared context as well
+    slot.fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+    glFlush();
+    slot.path = path;
+    slot.tag = tag;
+    slot.requested = std::chrono::steady_clock::now();
+
+    m_head = (m_head + 1) % static_cast<int>(m_slots.size());
+    m_pending++;
+}
+
+void FrameReadback::poll() {
+    std::lock_guard<std::mutex> lock(m_slotMutex);
+    int count = static_cast<int>(m_slots.size());
+    while (m_pending > 0) {
+        Slot& slot = m_slots[(m_head - m_pending + count) % count];
+        GLenum status = glClientWaitSync(slot.fence, 0, 0);
+        if (status != GL_ALREADY_SIGNALED && status != GL_CONDITION_SATISFIED) {
+            break;
+        }
+        collect(slot, false);
+        m_pending--;
+    }
+}
+
+void FrameReadback::flush() {
+    {
+        std::lock_guard<std::mutex> lock(m_slotMutex);
+        int count = static_cast<int>(m_slots.size());
+        while (m_pending > 0) {
+            collect(m_slots[(m_head - m_pending + count) % count], true);
+            m_pending--;
+        }
+    }
+
+    if (m_encoder) {
+        m_encoder->finish();
+    }
+}
+
+void FrameReadback::release() {
+    flush();
+
+    std::lock_guard<std::mutex> lock(m_slotMutex);
+    for (auto& slot : m_slots) {
+        if (slot.buffer != 0) {
+            glDeleteBuffers(1, &slot.buffer);
+            slot.buffer = 0;
+            slot.capacity = 0;
+        }
+    }
+}
+
+int FrameReadback::getFailedWrites() const {
+    std::lock_guard<std::mutex> lock(m_slotMutex);
+    return m_failedReads + (m_encoder ? m_encoder->getFailedWrites() : 0);
+}
+
+void FrameReadback::collect(Slot& slot, bool wait) {
+    if (wait) {
+        // Wait in slices so a lost context can't hang forever without a message
+        while (true) {
+            GLenum status = glClientWaitSync(slot.fence, GL_SYNC_FLUSH_COMMANDS_BIT, 1000000000);
+            if (status == GL_ALREADY_SIGNALED || status == GL_CONDITION_SATISFIED) {
+                break;
+            }
+            if (status == GL_WAIT_FAILED) {
+                LOG_ERROR("Waiting for the readback of {} failed", slot.path);
+                break;
+            }
+            LOG_WARN("Still waiting for the readback of {}", slot.path);
+        }
+    }
+    glDeleteSync(slot.fence);
+    slot.fence = nullptr;
+
+    if (m_consumer) {
+        glBindBuffer(GL_PIXEL_PACK_BUFFER, slot.buffer);
+        const void* data = glMapBufferRange(GL_PIXEL_PACK_BUFFER, 0, slot.capacity, GL_MAP_READ_BIT);
+        bool consumed = false;
+        if (data) {
+            MappedFrame frame{ slot.path, slot.width, slot.height, slot.requested,
+                               static_cast<const unsigned char*>(data), slot.tag };
+            consumed = m_consumer(frame);
+            glUnmapBuffer(GL_PIXEL_PACK_BUFFER);
+        } else {
+            LOG_ERROR("Failed to map the readback of {}", slot.path);
+        }
+        glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+        if (!consumed) {
+            m_failedReads++;
+        }
+        return;
+    }
+
+    FrameEncoder::Frame frame;
+    frame.path = slot.path;
+    frame.width = slot.width;
+    frame.height = slot.height;
+    frame.pixels.resize(static_cast<size_t>(slot.capacity));
+
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, slot.buffer);
+    const void* data = glMapBufferRange(GL_PIXEL_PACK_BUFFER, 0, slot.capacity, GL_MAP_READ_BIT);
+    if (data) {
+        std::memcpy(frame.pixels.data(), data, frame.pixels.size());
+        glUnmapBuffer(GL_PIXEL_PACK_BUFFER);
+    }
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+
+    if (!data) {
+        LOG_ERROR("Failed to map the readback of {}", slot.path);
+        m_failedReads++;
+        return;
+    }
+    m_encoder->submit(std::move(frame));
+}
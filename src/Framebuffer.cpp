@@ -2,8 +2,26 @@
 #include "Logger.h"
 #include "glad.h"
 
-Framebuffer::Framebuffer(int width, int height) 
-    : m_width(width), m_height(height), m_fbo(0), m_textureId(0), m_rbo(0) {
+// Pixel transfer format matching an internal format, needed to allocate the texture
+static void getTransferFormat(GLenum internalFormat, GLenum& format, GLenum& type) {
+    switch (internalFormat) {
+        case GL_R8:      format = GL_RED;  type = GL_UNSIGNED_BYTE; break;
+        case GL_R16F:
+        case GL_R32F:    format = GL_RED;  type = GL_FLOAT; break;
+        case GL_RG16F:
+        case GL_RG32F:   format = GL_RG;   type = GL_FLOAT; break;
+        case GL_RGBA8:   format = GL_RGBA; type = GL_UNSIGNED_BYTE; break;
+        case GL_RGBA16F:
+        case GL_RGBA32F: format = GL_RGBA; type = GL_FLOAT; break;
+        default:         format = GL_RGB;  type = GL_UNSIGNED_BYTE; break;
+    }
+}
+
+Framebuffer::Framebuffer(int width, int height, const std::vector<GLenum>& formats)
+    : m_fbo(0), m_formats(formats), m_rbo(0), m_width(width), m_height(height) {
+    if (m_formats.empty()) {
+        m_formats.push_back(GL_RGB8);
+    }
     setupFramebuffer();
 }
 
@@ -20,8 +38,15 @@ void Framebuffer::unbind() {
     glBindFramebuffer(GL_FRAMEBUFFER, 0);
 }
 
-GLuint Framebuffer::getTextureId() const {
-    return m_textureId;
+GLuint Framebuffer::getTextureId(int attachment) const {
+    if (attachment < 0 || attachment >= static_cast<int>(m_textureIds.size())) {
+        return 0;
+    }
+    return m_textureIds[attachment];
+}
+
+GLuint Framebuffer::getFramebufferId() const {
+    return m_fbo;
 }
 
 int Framebuffer::getWidth() const {
@@ -32,6 +57,14 @@ int Framebuffer::getHeight() const {
     return m_height;
 }
 
+int Framebuffer::getAttachmentCount() const {
+    return static_cast<int>(m_formats.size());
+}
+
+const std::vector<GLenum>& Framebuffer::getFormats() const {
+    return m_formats;
+}
+
 void Framebuffer::resize(int width, int height) {
     if (width == m_width && height == m_height) {
         return;
@@ -42,27 +75,66 @@ void Framebuffer::resize(int width, int height) {
     setupFramebuffer();
 }
 
+void Framebuffer::setFormats(const std::vector<GLenum>& formats) {
+    std::vector<GLenum> newFormats = formats.empty() ? std::vector<GLenum>{GL_RGB8} : formats;
+    if (newFormats == m_formats) {
+        return;
+    }
+    cleanup();
+    m_formats = newFormats;
+    setupFramebuffer();
+}
+
 void Framebuffer::setFilter(GLenum filter) {
-    glBindTexture(GL_TEXTURE_2D, m_textureId);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, filter);
+    for (GLuint textureId : m_textureIds) {
+        glBindTexture(GL_TEXTURE_2D, textureId);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, filter);
+    }
     glBindTexture(GL_TEXTURE_2D, 0);
 }
 
+void Framebuffer::selectAttachment(int attachment) {
+    glBindFramebuffer(GL_FRAMEBUFFER, m_fbo);
+    if (attachment < 0) {
+        std::vector<GLenum> drawBuffers;
+        for (size_t i = 0; i < m_formats.size(); i++) {
+            drawBuffers.push_back(GL_COLOR_ATTACHMENT0 + static_cast<GLenum>(i));
+        }
+        glDrawBuffers(static_cast<GLsizei>(drawBuffers.size()), drawBuffers.data());
+        glReadBuffer(GL_COLOR_ATTACHMENT0);
+    } else {
+        glDrawBuffer(GL_COLOR_ATTACHMENT0 + attachment);
+        glReadBuffer(GL_COLOR_ATTACHMENT0 + attachment);
+    }
+}
+
 void Framebuffer::setupFramebuffer() {
     // Generate FBO
     glGenFramebuffers(1, &m_fbo);
     glBindFramebuffer(GL_FRAMEBUFFER, m_fbo);
 
-    // Generate texture
-    glGenTextures(1, &m_textureId);
-    glBindTexture(GL_TEXTURE_2D, m_textureId);
-    glTexImage2D(GL_TEXTURE_2D, 0, GL_RGB, m_width, m_height, 0, GL_RGB, GL_UNSIGNED_BYTE, nullptr);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
-    glBindTexture(GL_TEXTURE_2D, 0);
-
-    // Attach texture to FBO
-    glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, m_textureId, 0);
+    // Generate one texture per colour attachment
+    std::vector<GLenum> drawBuffers;
+    for (size_t i = 0; i < m_formats.size(); i++) {
+        GLenum format, type;
+        getTransferFormat(m_formats[i], format, type);
+
+        GLuint textureId = 0;
+        glGenTextures(1, &textureId);
+        glBindTexture(GL_TEXTURE_2D, textureId);
+        glTexImage2D(GL_TEXTURE_2D, 0, m_formats[i], m_width, m_height, 0, format, type, nullptr);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+        glBindTexture(GL_TEXTURE_2D, 0);
+
+        GLenum attachment = GL_COLOR_ATTACHMENT0 + static_cast<GLenum>(i);
+        glFramebufferTexture2D(GL_FRAMEBUFFER, attachment, GL_TEXTURE_2D, textureId, 0);
+        m_textureIds.push_back(textureId);
+        drawBuffers.push_back(attachment);
+    }
+    if (drawBuffers.size() > 1) {
+        glDrawBuffers(static_cast<GLsizei>(drawBuffers.size()), drawBuffers.data());
+    }
 
     // Generate RBO (render buffer object) for depth and stencil attachment
     glGenRenderbuffers(1, &m_rbo);
@@ -85,9 +157,9 @@ void Framebuffer::cleanup() {
         glDeleteFramebuffers(1, &m_fbo);
         m_fbo = 0;
     }
-    if (m_textureId != 0) {
-        glDeleteTextures(1, &m_textureId);
-        m_textureId = 0;
+    if (!m_textureIds.empty()) {
+        glDeleteTextures(static_cast<GLsizei>(m_textureIds.size()), m_textureIds.data());
+        m_textureIds.clear();
     }
     if (m_rbo != 0) {
         glDeleteRenderbuffers(1, &m_rbo);
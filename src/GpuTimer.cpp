@@ -0,0 +1,66 @@
+#include "GpuTimer.h"
+#include "glad.h"
+
+GpuTimer::GpuTimer(int ringSize)
+    : m_slots(ringSize), m_head(0), m_pending(0), m_active(false) {
+    for (auto& slot : m_slots) {
+        glGenQueries(1, &slot.query);
+    }
+}
+
+GpuTimer::~GpuTimer() {
+    for (auto& slot : m_slots) {
+        if (slot.query != 0) {
+            glDeleteQueries(1, &slot.query);
+        }
+    }
+}
+
+bool GpuTimer::begin() {
+    if (m_active || m_pending >= static_cast<int>(m_slots.size())) {
+        return false;
+    }
+    glBeginQuery(GL_TIME_ELAPSED, m_slots[m_head].query);
+    m_active = true;
+    return true;
+}
+
+void GpuTimer::end(float time, float renderScaleFactor, float pixelFraction, int tileCount) {
+    if (!m_active) {
+        return;
+    }
+    glEndQuery(GL_TIME_ELAPSED);
+
+    Sample& sample = m_slots[m_head].sample;
+    sample.time = time;
+    sample.renderScaleFactor = renderScaleFactor;
+    sample.pixelFraction = pixelFraction;
+    sample.tileCount = tileCount;
+
+    m_head = (m_head + 1) % static_cast<int>(m_slots.size());
+    m_pending++;
+    m_active = false;
+}
+
+bool GpuTimer::poll(Sample& outSample) {
+    if (m_pending == 0) {
+        return false;
+    }
+
+    int size = static_cast<int>(m_slots.size());
+    Slot& oldest = m_slots[(m_head - m_pending + size) % size];
+
+    GLint available = 0;
+    glGetQueryObjectiv(oldest.query, GL_QUERY_RESULT_AVAILABLE, &available);
+    if (!available) {
+        return false;
+    }
+
+    GLuint64 elapsedNs = 0;
+    glGetQueryObjectui64v(oldest.query, GL_QUERY_RESULT, &elapsedNs);
+
+    outSample = oldest.sample;
+    outSample.milliseconds = static_cast<float>(elapsedNs) / 1.0e6f;
+    m_pending--;
+    return true;
+}
@@ -0,0 +1,466 @@
+#include "HeadlessRenderer.h"
+#include "ShaderManager.h"
+#include "ShaderProject.h"
+#include "FrameReadback.h"
+#include "PngStreamWriter.h"
+#include "Logger.h"
+#include "glad.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <filesystem>
+#include <vector>
+
+// Largest supersampled poster tile edge, small enough for software renderers
+static const int POSTER_TILE_LIMIT = 2048;
+
+// Largest edge of the passes feeding a poster, which are rendered once and not tiled
+static const int POSTER_INPUT_LIMIT = 4096;
+
+#ifdef FORK_EATER_HAVE_EGL
+#include <EGL/egl.h>
+#include <EGL/eglext.h>
+#endif
+
+HeadlessRenderer::HeadlessRenderer()
+    : m_display(nullptr)
+    , m_context(nullptr)
+    , m_failedFrames(0) {
+}
+
+HeadlessRenderer::~HeadlessRenderer() {
+    // GL objects must be released while the context is still current
+    if (m_frameReadback) {
+        m_frameReadback->release();
+    }
+    m_shaderManager.reset();
+    destroyContext();
+}
+
+bool HeadlessRenderer::initialize() {
+#ifdef FORK_EATER_HAVE_EGL
+    // Prefer the surfaceless platform (Mesa), which needs no X or Wayland server.
+    // Other drivers get the default display and a context without surfaces.
+    EGLDisplay display = EGL_NO_DISPLAY;
+    auto getPlatformDisplay = reinterpret_cast<PFNEGLGETPLATFORMDISPLAYEXTPROC>(
+        eglGetProcAddress("eglGetPlatformDisplayEXT"));
+    if (getPlatformDisplay) {
+        display = getPlatformDisplay(EGL_PLATFORM_SURFACELESS_MESA, EGL_DEFAULT_DISPLAY, nullptr);
+    }
+    if (display == EGL_NO_DISPLAY) {
+        display = eglGetDisplay(EGL_DEFAULT_DISPLAY);
+    }
+
+    EGLint major = 0, minor = 0;
+    if (display == EGL_NO_DISPLAY || !eglInitialize(display, &major, &minor)) {
+        LOG_ERROR("Failed to initialize EGL display");
+        return false;
+    }
+    m_display = display;
+    LOG_INFO("Initialized EGL {}.{}", major, minor);
+
+    if (!eglBindAPI(EGL_OPENGL_API)) {
+        LOG_ERROR("EGL display does not support desktop OpenGL");
+        return false;
+    }
+
+    // Nothing is ever presented, so any config (or none) will do
+    EGLConfig config = EGL_NO_CONFIG_KHR;
+    const EGLint configAttributes[] = { EGL_RENDERABLE_TYPE, EGL_OPENGL_BIT, EGL_NONE };
+    EGLint configCount = 0;
+    if (!eglChooseConfig(display, configAttributes, &config, 1, &configCount) || configCount == 0) {
+        config = EGL_NO_CONFIG_KHR;
+    }
+
+    const EGLint contextAttributes[] = {
+        EGL_CONTEXT_MAJOR_VERSION, 3,
+        EGL_CONTEXT_MINOR_VERSION, 3,
+        EGL_CONTEXT_OPENGL_PROFILE_MASK, EGL_CONTEXT_OPENGL_CORE_PROFILE_BIT,
+        EGL_NONE
+    };
+    EGLContext context = eglCreateContext(display, config, EGL_NO_CONTEXT, contextAttributes);
+    if (context == EGL_NO_CONTEXT) {
+        LOG_ERROR("Failed to create an OpenGL 3.3 core context (EGL error {})", eglGetError());
+        return false;
+    }
+    m_context = context;
+
+    if (!eglMakeCurrent(display, EGL_NO_SURFACE, EGL_NO_SURFACE, context)) {
+        LOG_ERROR("Failed to make the headless context current (EGL error {})", eglGetError());
+        return false;
+    }
+
+    if (!gladLoadGLLoader(reinterpret_cast<GLADloadproc>(eglGetProcAddress))) {
+        LOG_ERROR("Failed to initialize GLAD");
+        return false;
+    }
+
+    LOG_INFO("Headless renderer: {}", reinterpret_cast<const char*>(glGetString(GL_RENDERER)));
+    return true;
+#else
+    LOG_ERROR("Headless rendering is not available, this build has no EGL support");
+    return false;
+#endif
+}
+
+void HeadlessRenderer::destroyContext() {
+#ifdef FORK_EATER_HAVE_EGL
+    if (m_display) {
+        eglMakeCurrent(m_display, EGL_NO_SURFACE, EGL_NO_SURFACE, EGL_NO_CONTEXT);
+        if (m_context) {
+            eglDestroyContext(m_display, m_context);
+        }
+        eglTerminate(m_display);
+    }
+#endif
+    m_context = nullptr;
+    m_display = nullptr;
+}
+
+std::string HeadlessRenderer::getFrameFileName(int frame) {
+    char name[32];
+    std::snprintf(name, sizeof(name), "frame_%06d.png", frame);
+    return name;
+}
+
+bool HeadlessRenderer::renderSequence(const std::string& projectPath, const SequenceOptions& options) {
+    if (!beginSequence(projectPath, options)) {
+        return false;
+    }
+
+    // Frames are numbered by absolute time, so boxes rendering different ranges of the
+    // same sequence into one directory produce consistent, non-overlapping names
+    int firstFrame = getFirstFrame(options);
+    int endFrame = getEndFrame(options);
+    int rendered = 0;
+    int skipped = 0;
+    auto startClock = std::chrono::steady_clock::now();
+
+    for (int frame = firstFrame; frame < endFrame; frame++) {
+        bool frameSkipped = false;
+        if (!renderSequenceFrame(frame, frameSkipped)) {
+            break;
+        }
+        if (frameSkipped) {
+            skipped++;
+        } else {
+            rendered++;
+        }
+    }
+
+    if (!finishSequence()) {
+        return false;
+    }
+
+    float seconds = std::chrono::duration<float>(std::chrono::steady_clock::now() - startClock).count();
+    LOG_IMPORTANT("Rendered {} frames of pass '{}' to {} in {}s ({} already existed)",
+                  rendered, m_outputPass, options.output, seconds, skipped);
+    return true;
+}
+
+bool HeadlessRenderer::beginSequence(const std::string& projectPath, const SequenceOptions& options) {
+    if (options.fps <= 0.0f || options.width <= 0 || options.height <= 0 || options.endTime <= options.startTime) {
+        LOG_ERROR("Invalid sequence: {}s to {}s at {} fps, {}x{}",
+                  options.startTime, options.endTime, options.fps, options.width, options.height);
+        return false;
+    }
+    m_sequenceOptions = options;
+
+    auto encoder = std::make_shared<FrameEncoder>(options.encodeThreads);
+    bool streaming = options.format != FrameEncoder::Format::Png;
+    if (streaming && !encoder->openStream(options.output, options.format, options.fps)) {
+        return false;
+    }
+    m_frameReadback = std::make_unique<FrameReadback>(encoder);
+
+    if (!loadProject(projectPath, m_outputPass)) {
+        return false;
+    }
+
+    if (!streaming) {
+        std::error_code error;
+        std::filesystem::create_directories(options.output, error);
+        if (error) {
+            LOG_ERROR("Failed to create output directory {}: {}", options.output, error.message());
+            return false;
+        }
+    }
+    return true;
+}
+
+bool HeadlessRenderer::renderSequenceFrame(int frame, bool& skipped) {
+    const SequenceOptions& options = m_sequenceOptions;
+    skipped = false;
+
+    // A stream always carries the whole range, frame files are only rendered once
+    std::filesystem::path path;
+    if (options.format == FrameEncoder::Format::Png) {
+        path = std::filesystem::path(options.output) / getFrameFileName(frame);
+        if (std::filesystem::exists(path)) {
+            skipped = true;
+            return true;
+        }
+    }
+
+    float time = static_cast<float>(frame) / options.fps;
+    if (!renderFrame(time, options.width, options.height)) {
+        LOG_ERROR("Failed to render frame {} (time {}s)", frame, time);
+        m_failedFrames++;
+        return false;
+    }
+    GLuint textureId = m_shaderManager->getFramebufferTexture(m_outputPass);
+    if (textureId == 0) {
+        LOG_ERROR("Framebuffer for pass '{}' not found.", m_outputPass);
+        m_failedFrames++;
+        return false;
+    }
+
+    // The next frames are rendered while this one is read back and encoded
+    m_frameReadback->request(textureId, path.string());
+    m_frameReadback->poll();
+    LOG_DEBUG("Rendered frame {} (time {}s)", frame, time);
+
+    // Typically a closed pipe, rendering the remaining frames would be wasted
+    return m_frameReadback->getFailedWrites() == 0;
+}
+
+bool HeadlessRenderer::finishSequence() {
+    if (!m_frameReadback) {
+        return false;
+    }
+    m_frameReadback->flush();
+    if (m_frameReadback->getFailedWrites() > 0) {
+        LOG_ERROR("{} frames could not be written", m_frameReadback->getFailedWrites());
+        return false;
+    }
+    return m_failedFrames == 0;
+}
+
+int HeadlessRenderer::getFirstFrame(const SequenceOptions& options) {
+    return static_cast<int>(std::lround(options.startTime * options.fps));
+}
+
+int HeadlessRenderer::getEndFrame(const SequenceOptions& options) {
+    return std::max(getFirstFrame(options) + 1, static_cast<int>(std::lround(options.endTime * options.fps)));
+}
+
+bool HeadlessRenderer::openProject(const std::string& projectPath) {
+    return loadProject(projectPath, m_outputPass);
+}
+
+bool HeadlessRenderer::renderImage(float time, int width, int height, std::vector<unsigned char>& pixels) {
+    if (!m_project || !renderFrame(time, width, height)) {
+        return false;
+    }
+    GLuint textureId = m_shaderManager->getFramebufferTexture(m_outputPass);
+    if (textureId == 0) {
+        LOG_ERROR("Framebuffer for pass '{}' not found.", m_outputPass);
+        return false;
+    }
+
+    GLint textureWidth = 0;
+    GLint textureHeight = 0;
+    glBindTexture(GL_TEXTURE_2D, textureId);
+    glGetTexLevelParameteriv(GL_TEXTURE_2D, 0, GL_TEXTURE_WIDTH, &textureWidth);
+    glGetTexLevelParameteriv(GL_TEXTURE_2D, 0, GL_TEXTURE_HEIGHT, &textureHeight);
+    if (textureWidth != width || textureHeight != height) {
+        LOG_ERROR("Pass '{}' rendered at {}x{} instead of {}x{}", m_outputPass, textureWidth, textureHeight, width, height);
+        return false;
+    }
+    pixels.resize(static_cast<size_t>(width) * height * 4);
+    glGetTexImage(GL_TEXTURE_2D, 0, GL_RGBA, GL_UNSIGNED_BYTE, pixels.data());
+    return glGetError() == GL_NO_ERROR;
+}
+
+bool HeadlessRenderer::renderPoster(const std::string& projectPath, const PosterOptions& options) {
+    if (options.width <= 0 || options.height <= 0 || options.supersample < 1 || options.supersample > 16) {
+        LOG_ERROR("Invalid poster: {}x{} with {}x{} supersampling",
+                  options.width, options.height, options.supersample, options.supersample);
+        return false;
+    }
+
+    std::string outputPass;
+    if (!loadProject(projectPath, outputPass)) {
+        return false;
+    }
+
+    GLint maxTextureSize = 0;
+    glGetIntegerv(GL_MAX_TEXTURE_SIZE, &maxTextureSize);
+    const int supersample = options.supersample;
+    const int tileSize = std::max(1, std::min(static_cast<int>(maxTextureSize), POSTER_TILE_LIMIT) / supersample);
+    const int tileWidth = std::min(tileSize, options.width);
+    const int tileHeight = std::min(tileSize, options.height);
+    const int columns = (options.width + tileWidth - 1) / tileWidth;
+    const int rows = (options.height + tileHeight - 1) / tileHeight;
+
+    // Tiles are views into the output pass, which needs the gl_FragCoord mapping to be zoomed
+    auto shader = m_shaderManager->getShader(outputPass);
+    if (columns * rows > 1 && shader && !shader->fragCoordMapped) {
+        LOG_ERROR("Pass '{}' redeclares gl_FragCoord and can't be rendered in tiles, the poster must fit into {}x{}",
+                  outputPass, tileWidth, tileHeight);
+        return false;
+    }
+    LOG_INFO("Rendering {}x{} poster of pass '{}' as {}x{} tiles of {}x{} with {}x{} supersampling",
+             options.width, options.height, outputPass, columns, rows, tileWidth, tileHeight, supersample, supersample);
+
+    // Passes feeding the final one are rendered once at the poster size, fitted into a
+    // single texture. The final pass samples them in full-frame coordinates.
+    float inputLimit = static_cast<float>(std::min(static_cast<int>(maxTextureSize), POSTER_INPUT_LIMIT));
+    float fit = std::min(1.0f, std::min(inputLimit / options.width, inputLimit / options.height));
+    int inputWidth = std::max(1, static_cast<int>(options.width * fit));
+    int inputHeight = std::max(1, static_cast<int>(options.height * fit));
+    for (const auto& pass : m_project->getPasses()) {
+        if (pass.enabled && pass.name != outputPass) {
+            std::pair<int, int> size = resolvePassSize(pass, inputWidth, inputHeight, 0);
+            m_shaderManager->renderToFramebuffer(pass.name, size.first, size.second, options.time, 1.0f, RenderScaleMode::Resolution);
+        }
+    }
+
+    PngStreamWriter writer;
+    if (!writer.open(options.output, options.width, options.height)) {
+        return false;
+    }
+
+    // Only one supersampled tile and one downsampled row of tiles are ever in memory
+    const int sampleWidth = tileWidth * supersample;
+    const int sampleHeight = tileHeight * supersample;
+    const int samples = supersample * supersample;
+    std::vector<unsigned char> tilePixels(static_cast<size_t>(sampleWidth) * sampleHeight * 4);
+    std::vector<unsigned char> rowPixels(static_cast<size_t>(options.width) * tileHeight * 3);
+    auto startClock = std::chrono::steady_clock::now();
+
+    for (int row = 0; row < rows; row++) {
+        // PNG rows go top to bottom, GL rows bottom to top. A partial last row of tiles
+        // extends below the image and only its upper part is kept.
+        int top = row * tileHeight;
+        int rowHeight = std::min(tileHeight, options.height - top);
+        int bottom = options.height - top - tileHeight;
+
+        for (int column = 0; column < columns; column++) {
+            int left = column * tileWidth;
+            int columnWidth = std::min(tileWidth, options.width - left);
+
+            // The tile is the view rectangle of a virtual supersampled poster, so
+            // resolution uniforms and gl_FragCoord cover the whole image
+            m_shaderManager->setPreviewView(outputPass,
+                static_cast<float>(left) / options.width, static_cast<float>(bottom) / options.height,
+                static_cast<float>(tileWidth) / options.width, static_cast<float>(tileHeight) / options.height);
+            m_shaderManager->renderToFramebuffer(outputPass, sampleWidth, sampleHeight, options.time, 1.0f, RenderScaleMode::Resolution);
+
+            // The next tile needs the framebuffer, so the readback is synchronous
+            glBindTexture(GL_TEXTURE_2D, m_shaderManager->getFramebufferTexture(outputPass));
+            glGetTexImage(GL_TEXTURE_2D, 0, GL_RGBA, GL_UNSIGNED_BYTE, tilePixels.data());
+            if (glGetError() != GL_NO_ERROR) {
+                LOG_ERROR("Failed to render poster tile {},{}", column, row);
+                m_shaderManager->setPreviewView("", 0.0f, 0.0f, 1.0f, 1.0f);
+                return false;
+            }
+
+            // Box filter each supersample block into one output pixel
+            for (int y = 0; y < rowHeight; y++) {
+                int sampleY = (tileHeight - 1 - y) * supersample;
+                unsigned char* target = rowPixels.data() + (static_cast<size_t>(y) * options.width + left) * 3;
+                for (int x = 0; x < columnWidth; x++) {
+                    int sum[3] = {0, 0, 0};
+                    for (int sy = 0; sy < supersample; sy++) {
+                        const unsigned char* source = tilePixels.data()
+                            + (static_cast<size_t>(sampleY + sy) * sampleWidth + x * supersample) * 4;
+                        for (int sx = 0; sx < supersample; sx++) {
+                            sum[0] += source[sx * 4];
+                            sum[1] += source[sx * 4 + 1];
+                            sum[2] += source[sx * 4 + 2];
+                        }
+                    }
+                    for (int c = 0; c < 3; c++) {
+                        target[x * 3 + c] = static_cast<unsigned char>((sum[c] + samples / 2) / samples);
+                    }
+                }
+            }
+        }
+
+        if (!writer.writeRows(rowPixels.data(), rowHeight)) {
+            m_shaderManager->setPreviewView("", 0.0f, 0.0f, 1.0f, 1.0f);
+            return false;
+        }
+        LOG_DEBUG("Poster row {}/{} done", row + 1, rows);
+    }
+    m_shaderManager->setPreviewView("", 0.0f, 0.0f, 1.0f, 1.0f);
+
+    if (!writer.close()) {
+        return false;
+    }
+    float seconds = std::chrono::duration<float>(std::chrono::steady_clock::now() - startClock).count();
+    LOG_IMPORTANT("Rendered {}x{} poster to {} in {}s", options.width, options.height, options.output, seconds);
+    return true;
+}
+
+bool HeadlessRenderer::loadProject(const std::string& projectPath, std::string& outputPass) {
+    m_shaderManager = std::make_shared<ShaderManager>();
+    m_project = std::make_shared<ShaderProject>();
+    if (!m_project->loadFromDirectory(projectPath)) {
+        LOG_ERROR("Failed to load project from {}", projectPath);
+        return false;
+    }
+    m_project->loadState(m_shaderManager);
+    if (!m_project->loadShadersIntoManager(m_shaderManager)) {
+        LOG_ERROR("Failed to load shaders from project: {}", projectPath);
+        return false;
+    }
+
+    // The last enabled pass is the final image. Nobody watches the output of an offline
+    // render, so a pass that does not compile fails it instead of rendering black.
+    outputPass.clear();
+    for (const auto& pass : m_project->getPasses()) {
+        if (!pass.enabled) {
+            continue;
+        }
+        auto shader = m_shaderManager->getShader(pass.name);
+        if (!shader || !shader->isValid) {
+            LOG_ERROR("Pass '{}' failed to compile: {}", pass.name, shader ? shader->lastError : std::string("not loaded"));
+            return false;
+        }
+        outputPass = pass.name;
+    }
+    if (outputPass.empty()) {
+        LOG_ERROR("Project has no enabled pass to render");
+        return false;
+    }
+    return true;
+}
+
+std::pair<int, int> HeadlessRenderer::resolvePassSize(const ShaderPass& pass, int width, int height, int depth) const {
+    // Same rules as the editor at output resolution: explicit sizes win, relative sizes
+    // follow the output or the referenced pass
+    const int maxDepth = 8;
+
+    std::pair<int, int> size = {width, height};
+    if (pass.width > 0 && pass.height > 0) {
+        size = {pass.width, pass.height};
+    }
+    if (pass.scale > 0.0f) {
+        if (!pass.scaleRelativeTo.empty() && depth < maxDepth) {
+            for (const auto& source : m_project->getPasses()) {
+                if (source.name == pass.scaleRelativeTo) {
+                    size = resolvePassSize(source, width, height, depth + 1);
+                    break;
+                }
+            }
+        }
+        size.first = std::max(1, static_cast<int>(std::lround(size.first * pass.scale)));
+        size.second = std::max(1, static_cast<int>(std::lround(size.second * pass.scale)));
+    }
+    return size;
+}
+
+bool HeadlessRenderer::renderFrame(float time, int width, int height) {
+    // Full scale in resolution mode draws every pass completely in a single call
+    for (const auto& pass : m_project->getPasses()) {
+        if (!pass.enabled) {
+            continue;
+        }
+        std::pair<int, int> size = resolvePassSize(pass, width, height, 0);
+        m_shaderManager->renderToFramebuffer(pass.name, size.first, size.second, time, 1.0f, RenderScaleMode::Resolution);
+    }
+    return glGetError() == GL_NO_ERROR;
+}
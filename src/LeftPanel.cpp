@@ -39,11 +39,16 @@ void LeftPanel::renderPassList() {
         for (size_t i = 0; i < passes.size(); ++i) {
             auto& pass = passes[i];
             bool selected = (i == 0); // For now, just select the first pass
-            std::string displayName = pass.name + (pass.enabled ? "" : " (disabled)");
+            std::string displayName = pass.name + (pass.enabled ? "" : " (disabled)") + (pass.pinScale ? " (full scale)" : "");
             if (ImGui::Selectable(displayName.c_str(), selected)) {
                 pass.enabled = !pass.enabled;
                 if (onPassesChanged) onPassesChanged();
             }
+            if (ImGui::BeginPopupContextItem()) {
+                // Read by the render scale controller every frame, no reload needed
+                ImGui::MenuItem("Pin at Full Scale", nullptr, &pass.pinScale);
+                ImGui::EndPopup();
+            }
         }
     } else {
         ImGui::Text("No project loaded");
@@ -32,6 +32,10 @@ bool Logger::isDebugEnabled() const {
     return m_debugMode;
 }
 
+void Logger::setLogToStderr(bool enabled) {
+    m_logToStderr = enabled;
+}
+
 void Logger::debug(const std::string& message) {
     if (shouldLog(LogLevel::DEBUG)) {
         logMessage(LogLevel::DEBUG, message);
@@ -69,7 +73,7 @@ void Logger::important(const std::string& message) {
 }
 
 void Logger::logMessage(LogLevel level, const std::string& message) {
-    std::ostream& output = (level == LogLevel::ERROR) ? std::cerr : std::cout;
+    std::ostream& output = (level == LogLevel::ERROR || m_logToStderr) ? std::cerr : std::cout;
     
     if (m_colorSupport) {
         output << getColorCode(level);
@@ -62,6 +62,16 @@ void MenuSystem::renderRenderMenu() {
 
     ImGui::Separator();
 
+    ImGui::Text("Render Mode:");
+
+    const char* renderModes[] = { "Resolution", "Chunk", "Auto", "Tiled" };
+    int currentRenderMode = static_cast<int>(Settings::getInstance().getRenderScaleMode());
+    if (ImGui::Combo("##rendermode", &currentRenderMode, renderModes, IM_ARRAYSIZE(renderModes))) {
+        Settings::getInstance().setRenderScaleMode(static_cast<RenderScaleMode>(currentRenderMode));
+    }
+
+    ImGui::Separator();
+
     ImGui::Text("Screen Size:");
     if (ImGui::MenuItem("1280x720")) {
         if (onScreenSizeChanged) onScreenSizeChanged(1280, 720);
@@ -164,6 +174,92 @@ void MenuSystem::renderSettingsWindow() {
             settings.setLowFPSRenderThreshold25(static_cast<float>(lowRenderThreshold25));
         }
 
+        ImGui::Spacing();
+        ImGui::Separator();
+        ImGui::Text("Adaptive Render Scale");
+
+        float frameBudget = settings.getFrameBudgetMs();
+        if (ImGui::SliderFloat("Frame Budget", &frameBudget, 1.0f, 100.0f, "%.0f ms")) {
+            settings.setFrameBudgetMs(frameBudget);
+        }
+        if (ImGui::IsItemHovered()) {
+            ImGui::SetTooltip("GPU time per frame the render scale is adjusted to");
+        }
+
+        const char* chunkMethods[] = { "Stipple", "Scatter" };
+        int currentChunkMethod = static_cast<int>(settings.getChunkMethod());
+        if (ImGui::Combo("Chunk Method", &currentChunkMethod, chunkMethods, IM_ARRAYSIZE(chunkMethods))) {
+            settings.setChunkMethod(static_cast<ChunkMethod>(currentChunkMethod));
+        }
+        if (ImGui::IsItemHovered()) {
+            ImGui::SetTooltip("Scatter only runs the shader for the pixels of the current chunk phase");
+        }
+
+        const char* upscaleFilters[] = { "Bilinear", "Lanczos" };
+        int currentFilter = static_cast<int>(settings.getUpscaleFilter());
+        if (ImGui::Combo("Upscale Filter", &currentFilter, upscaleFilters, IM_ARRAYSIZE(upscaleFilters))) {
+            settings.setUpscaleFilter(static_cast<UpscaleFilter>(currentFilter));
+        }
+        if (ImGui::IsItemHovered()) {
+            ImGui::SetTooltip("How passes rendered below full resolution are scaled up for display");
+        }
+
+        bool renderAtPreviewSize = settings.getRenderAtPreviewSize();
+        if (ImGui::Checkbox("Render at Preview Size", &renderAtPreviewSize)) {
+            settings.setRenderAtPreviewSize(renderAtPreviewSize);
+        }
+        if (ImGui::IsItemHovered()) {
+            ImGui::SetTooltip("Render passes at the size of the preview; screenshots still use the output resolution");
+        }
+
+        ImGui::Spacing();
+        ImGui::Separator();
+        ImGui::Text("Tiled Rendering");
+
+        float tileBudget = settings.getTileBudgetMs();
+        if (ImGui::SliderFloat("Tile Budget", &tileBudget, 1.0f, 100.0f, "%.0f ms")) {
+            settings.setTileBudgetMs(tileBudget);
+        }
+        if (ImGui::IsItemHovered()) {
+            ImGui::SetTooltip("Time spent rendering tiles of a pass per UI frame");
+        }
+
+        bool adaptiveRefresh = settings.getAdaptiveRefresh();
+        if (ImGui::Checkbox("Adaptive Refresh", &adaptiveRefresh)) {
+            settings.setAdaptiveRefresh(adaptiveRefresh);
+        }
+        if (ImGui::IsItemHovered()) {
+            ImGui::SetTooltip("During playback, refresh tiles (in chunk mode, their stipple phases) that change quickly more often than static ones");
+        }
+
+        bool renderThread = settings.getRenderThreadEnabled();
+        if (ImGui::Checkbox("Render on Separate Thread", &renderThread)) {
+            settings.setRenderThreadEnabled(renderThread);
+        }
+        if (ImGui::IsItemHovered()) {
+            ImGui::SetTooltip("Keeps the UI responsive while passes render (restart required)");
+        }
+
+        ImGui::Spacing();
+        ImGui::Separator();
+        ImGui::Text("Frame Cache");
+
+        int frameCacheMemory = settings.getFrameCacheMemoryMB();
+        if (ImGui::SliderInt("Cache Memory", &frameCacheMemory, 0, 4096, "%d MB")) {
+            settings.setFrameCacheMemoryMB(frameCacheMemory);
+        }
+        if (ImGui::IsItemHovered()) {
+            ImGui::SetTooltip("Compressed frames kept to show instantly when scrubbing back (0 disables)");
+        }
+
+        bool timelineThumbnails = settings.getTimelineThumbnails();
+        if (ImGui::Checkbox("Timeline Thumbnails", &timelineThumbnails)) {
+            settings.setTimelineThumbnails(timelineThumbnails);
+        }
+        if (ImGui::IsItemHovered()) {
+            ImGui::SetTooltip("Show small frames of the previewed pass along the timeline, rendered in leftover frame budget");
+        }
+
         ImGui::Spacing();
         if (ImGui::Button("Close")) {
             m_showSettingsWindow = false;
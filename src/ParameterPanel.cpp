@@ -2,6 +2,9 @@
 #include "imgui.h"
 #include "Settings.h"
 #include "RenderScaleMode.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
 
 ParameterPanel::ParameterPanel(std::shared_ptr<ShaderManager> shaderManager, std::shared_ptr<ShaderProject> shaderProject)
     : m_shaderManager(shaderManager), m_shaderProject(shaderProject) {}
@@ -74,24 +77,8 @@ void ParameterPanel::render(const std::string& shaderName) {
                     break;
             }
 
-            if (valueChanged && m_shaderProject) {
-                std::vector<float> values;
-                switch (uniform.type) {
-                    case GL_FLOAT:
-                        values.assign(uniform.value, uniform.value + 1);
-                        break;
-                    case GL_FLOAT_VEC2:
-                        values.assign(uniform.value, uniform.value + 2);
-                        break;
-                    case GL_FLOAT_VEC3:
-                        values.assign(uniform.value, uniform.value + 3);
-                        break;
-                    case GL_FLOAT_VEC4:
-                        values.assign(uniform.value, uniform.value + 4);
-                        break;
-                }
-                m_shaderProject->getUniformValues()[shaderName][uniform.name] = values;
-                m_shaderProject->saveState(m_shaderManager);
+            if (valueChanged) {
+                storeUniformValues(shaderName, uniform);
             }
         }
         
@@ -195,8 +182,156 @@ void ParameterPanel::render(const std::string& shaderName) {
              ImGui::Unindent();
         }
     }
+
+    if (hasUniforms) {
+        renderSweep(shaderName, *shader);
+    }
 }
 
 void ParameterPanel::setProject(std::shared_ptr<ShaderProject> shaderProject) {
     m_shaderProject = shaderProject;
 }
+
+bool ParameterPanel::takeSweepRequest(UniformSweep& sweep) {
+    if (!m_sweepRequested) {
+        return false;
+    }
+    sweep = m_sweep;
+    m_sweepRequested = false;
+    return true;
+}
+
+void ParameterPanel::storeUniformValues(const std::string& shaderName, const ShaderUniform& uniform) {
+    if (!m_shaderProject) {
+        return;
+    }
+    std::vector<float> values;
+    switch (uniform.type) {
+        case GL_FLOAT:
+            values.assign(uniform.value, uniform.value + 1);
+            break;
+        case GL_FLOAT_VEC2:
+            values.assign(uniform.value, uniform.value + 2);
+            break;
+        case GL_FLOAT_VEC3:
+            values.assign(uniform.value, uniform.value + 3);
+            break;
+        case GL_FLOAT_VEC4:
+            values.assign(uniform.value, uniform.value + 4);
+            break;
+    }
+    m_shaderProject->getUniformValues()[shaderName][uniform.name] = values;
+    m_shaderProject->saveState(m_shaderManager);
+}
+
+void ParameterPanel::renderSweep(const std::string& shaderName, ShaderManager::ShaderProgram& shader) {
+    // Every component of a uniform with a range can be swept
+    std::vector<UniformSweep::Axis> axes;
+    std::vector<std::string> labels;
+    for (const auto& uniform : shader.uniforms) {
+        if (uniform.name == "iTime" || uniform.name == "iResolution" || uniform.name == "iMouse") {
+            continue;
+        }
+        int components = uniform.type == GL_FLOAT_VEC2 ? 2 : uniform.type == GL_FLOAT_VEC3 ? 3 : uniform.type == GL_FLOAT_VEC4 ? 4 : 1;
+        std::string label = uniform.label.empty() ? uniform.name : uniform.label;
+        for (int component = 0; component < components; component++) {
+            axes.push_back({uniform.name, component, uniform.min, uniform.max});
+            labels.push_back(components > 1 ? label + "." + "xyzw"[component] : label);
+        }
+    }
+    if (axes.empty()) {
+        return;
+    }
+
+    ImGui::Separator();
+    ImGui::TextDisabled("Parameter Sweep:");
+
+    auto findAxis = [&axes](const UniformSweep::Axis& axis) {
+        for (size_t i = 0; i < axes.size(); i++) {
+            if (axes[i].uniform == axis.uniform && axes[i].component == axis.component) {
+                return static_cast<int>(i);
+            }
+        }
+        return -1;
+    };
+    std::vector<const char*> xItems;
+    std::vector<const char*> yItems = { "None" };
+    for (const auto& label : labels) {
+        xItems.push_back(label.c_str());
+        yItems.push_back(label.c_str());
+    }
+
+    int xIndex = std::max(0, findAxis(m_sweep.x));
+    int yIndex = m_sweep.y.uniform.empty() ? 0 : findAxis(m_sweep.y) + 1;
+    ImGui::Combo("Sweep X", &xIndex, xItems.data(), static_cast<int>(xItems.size()));
+    ImGui::Combo("Sweep Y", &yIndex, yItems.data(), static_cast<int>(yItems.size()));
+    ImGui::SliderInt("Grid Size", &m_sweepGridSize, 2, 8);
+    m_sweep.x = axes[xIndex];
+    m_sweep.y = yIndex > 0 ? axes[yIndex - 1] : UniformSweep::Axis();
+
+    if (ImGui::Button("Render Sweep")) {
+        // Cells keep the aspect of the pass
+        std::pair<int, int> size = m_shaderManager->getFramebufferSize(shaderName);
+        float aspect = size.second > 0 ? static_cast<float>(size.first) / static_cast<float>(size.second) : 16.0f / 9.0f;
+        m_sweep.pass = shaderName;
+        m_sweep.columns = m_sweepGridSize;
+        m_sweep.rows = m_sweepGridSize;
+        m_sweep.cellHeight = 90;
+        m_sweep.cellWidth = std::clamp(static_cast<int>(std::lround(90.0f * aspect)), 16, 360);
+        m_sweepRequested = true;
+    }
+    if (ImGui::IsItemHovered()) {
+        ImGui::SetTooltip("Render a grid of variants across the range of the chosen parameters at the current time");
+    }
+
+    UniformSweep rendered;
+    GLuint textureId = m_shaderManager->getUniformSweepTexture(rendered);
+    if (textureId == 0 || rendered.pass != shaderName) {
+        return;
+    }
+
+    float width = ImGui::GetContentRegionAvail().x;
+    float height = width * static_cast<float>(rendered.rows * rendered.cellHeight) / static_cast<float>(rendered.columns * rendered.cellWidth);
+    ImGui::Image((void*)(intptr_t)textureId, ImVec2(width, height), ImVec2(0, 1), ImVec2(1, 0));
+    if (!ImGui::IsItemHovered()) {
+        return;
+    }
+
+    ImVec2 origin = ImGui::GetItemRectMin();
+    ImVec2 mouse = ImGui::GetMousePos();
+    int column = std::clamp(static_cast<int>((mouse.x - origin.x) / width * rendered.columns), 0, rendered.columns - 1);
+    int row = std::clamp(static_cast<int>((mouse.y - origin.y) / height * rendered.rows), 0, rendered.rows - 1);
+    int cell = row * rendered.columns + column;
+
+    float cellWidth = width / static_cast<float>(rendered.columns);
+    float cellHeight = height / static_cast<float>(rendered.rows);
+    ImVec2 cellMin(origin.x + column * cellWidth, origin.y + row * cellHeight);
+    ImGui::GetWindowDrawList()->AddRect(cellMin, ImVec2(cellMin.x + cellWidth, cellMin.y + cellHeight), IM_COL32(255, 255, 255, 255));
+
+    if (rendered.y.uniform.empty()) {
+        ImGui::SetTooltip("%s = %.3f\nClick to use this value", rendered.x.uniform.c_str(), rendered.getX(cell));
+    } else {
+        ImGui::SetTooltip("%s = %.3f\n%s = %.3f\nClick to use these values", rendered.x.uniform.c_str(), rendered.getX(cell),
+                          rendered.y.uniform.c_str(), rendered.getY(cell));
+    }
+    if (ImGui::IsItemClicked()) {
+        adoptSweepCell(shaderName, shader, rendered, cell);
+    }
+}
+
+void ParameterPanel::adoptSweepCell(const std::string& shaderName, ShaderManager::ShaderProgram& shader, const UniformSweep& sweep, int cell) {
+    for (auto& uniform : shader.uniforms) {
+        bool changed = false;
+        if (uniform.name == sweep.x.uniform) {
+            uniform.value[std::clamp(sweep.x.component, 0, 3)] = sweep.getX(cell);
+            changed = true;
+        }
+        if (!sweep.y.uniform.empty() && uniform.name == sweep.y.uniform) {
+            uniform.value[std::clamp(sweep.y.component, 0, 3)] = sweep.getY(cell);
+            changed = true;
+        }
+        if (changed) {
+            storeUniformValues(shaderName, uniform);
+        }
+    }
+}
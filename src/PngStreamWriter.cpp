@@ -0,0 +1,186 @@
+#include "PngStreamWriter.h"
+#include "Logger.h"
+#include <cstring>
+#include <filesystem>
+
+// Size of the compressed data collected before it is written out as one IDAT chunk
+static const size_t IDAT_CHUNK_SIZE = 1 << 20;
+
+static void storeBigEndian(unsigned char* target, unsigned int value) {
+    target[0] = static_cast<unsigned char>(value >> 24);
+    target[1] = static_cast<unsigned char>(value >> 16);
+    target[2] = static_cast<unsigned char>(value >> 8);
+    target[3] = static_cast<unsigned char>(value);
+}
+
+PngStreamWriter::PngStreamWriter()
+    : m_file(nullptr)
+    , m_stream()
+    , m_streamInitialized(false)
+    , m_width(0)
+    , m_height(0)
+    , m_rowsWritten(0) {
+}
+
+PngStreamWriter::~PngStreamWriter() {
+    if (m_file) {
+        abort();
+    }
+}
+
+bool PngStreamWriter::open(const std::string& path, int width, int height) {
+    m_path = path;
+    m_temporaryPath = path + ".part";
+    m_width = width;
+    m_height = height;
+    m_rowsWritten = 0;
+
+    m_file = std::fopen(m_temporaryPath.c_str(), "wb");
+    if (!m_file) {
+        LOG_ERROR("Failed to open {} for writing", m_temporaryPath);
+        return false;
+    }
+
+    std::memset(&m_stream, 0, sizeof(m_stream));
+    if (deflateInit(&m_stream, Z_DEFAULT_COMPRESSION) != Z_OK) {
+        LOG_ERROR("Failed to initialize PNG compression");
+        abort();
+        return false;
+    }
+    m_streamInitialized = true;
+
+    // Each row is prefixed with its filter type, the Sub filter needs no previous row
+    m_filteredRow.resize(static_cast<size_t>(width) * 3 + 1);
+    m_compressed.reserve(IDAT_CHUNK_SIZE);
+
+    static const unsigned char signature[8] = { 0x89, 'P', 'N', 'G', '\r', '\n', 0x1a, '\n' };
+    unsigned char header[13];
+    storeBigEndian(header, static_cast<unsigned int>(width));
+    storeBigEndian(header + 4, static_cast<unsigned int>(height));
+    header[8] = 8;  // Bit depth
+    header[9] = 2;  // Truecolor
+    header[10] = 0; // Deflate
+    header[11] = 0; // Adaptive filtering
+    header[12] = 0; // No interlace
+    if (std::fwrite(signature, 1, sizeof(signature), m_file) != sizeof(signature)
+        || !writeChunk("IHDR", header, sizeof(header))) {
+        abort();
+        return false;
+    }
+    return true;
+}
+
+bool PngStreamWriter::writeRows(const unsigned char* rows, int count) {
+    if (!m_file || m_rowsWritten + count > m_height) {
+        return false;
+    }
+
+    const size_t stride = static_cast<size_t>(m_width) * 3;
+    for (int row = 0; row < count; row++) {
+        const unsigned char* source = rows + row * stride;
+        m_filteredRow[0] = 1;
+        for (size_t i = 0; i < stride; i++) {
+            unsigned char left = i >= 3 ? source[i - 3] : 0;
+            m_filteredRow[i + 1] = static_cast<unsigned char>(source[i] - left);
+        }
+        if (!compress(m_filteredRow.data(), m_filteredRow.size(), Z_NO_FLUSH)) {
+            abort();
+            return false;
+        }
+    }
+    m_rowsWritten += count;
+    return true;
+}
+
+bool PngStreamWriter::close() {
+    if (!m_file) {
+        return false;
+    }
+    if (m_rowsWritten != m_height) {
+        LOG_ERROR("Only {} of {} rows were written to {}", m_rowsWritten, m_height, m_path);
+        abort();
+        return false;
+    }
+
+    if (!compress(nullptr, 0, Z_FINISH) || !writeChunk("IEND", nullptr, 0)) {
+        abort();
+        return false;
+    }
+    deflateEnd(&m_stream);
+    m_streamInitialized = false;
+
+    bool closed = std::fclose(m_file) == 0;
+    m_file = nullptr;
+    if (!closed) {
+        LOG_ERROR("Failed to write {}", m_path);
+        std::remove(m_temporaryPath.c_str());
+        return false;
+    }
+
+    std::error_code error;
+    std::filesystem::rename(m_temporaryPath, m_path, error);
+    if (error) {
+        LOG_ERROR("Failed to rename {} to {}: {}", m_temporaryPath, m_path, error.message());
+        return false;
+    }
+    return true;
+}
+
+bool PngStreamWriter::compress(const unsigned char* data, size_t size, int flush) {
+    m_stream.next_in = const_cast<Bytef*>(data);
+    m_stream.avail_in = static_cast<uInt>(size);
+
+    unsigned char buffer[65536];
+    int result = Z_OK;
+    do {
+        m_stream.next_out = buffer;
+        m_stream.avail_out = sizeof(buffer);
+        result = deflate(&m_stream, flush);
+        if (result == Z_STREAM_ERROR) {
+            LOG_ERROR("PNG compression failed");
+            return false;
+        }
+        m_compressed.insert(m_compressed.end(), buffer, buffer + (sizeof(buffer) - m_stream.avail_out));
+
+        if (m_compressed.size() >= IDAT_CHUNK_SIZE || (flush == Z_FINISH && !m_compressed.empty())) {
+            if (!writeChunk("IDAT", m_compressed.data(), m_compressed.size())) {
+                return false;
+            }
+            m_compressed.clear();
+        }
+    } while (m_stream.avail_out == 0 || (flush == Z_FINISH && result != Z_STREAM_END));
+    return true;
+}
+
+bool PngStreamWriter::writeChunk(const char* type, const unsigned char* data, size_t size) {
+    unsigned char length[4];
+    storeBigEndian(length, static_cast<unsigned int>(size));
+
+    uLong crc = crc32(0L, reinterpret_cast<const Bytef*>(type), 4);
+    if (size > 0) {
+        crc = crc32(crc, data, static_cast<uInt>(size));
+    }
+    unsigned char checksum[4];
+    storeBigEndian(checksum, static_cast<unsigned int>(crc));
+
+    bool written = std::fwrite(length, 1, 4, m_file) == 4
+        && std::fwrite(type, 1, 4, m_file) == 4
+        && (size == 0 || std::fwrite(data, 1, size, m_file) == size)
+        && std::fwrite(checksum, 1, 4, m_file) == 4;
+    if (!written) {
+        LOG_ERROR("Failed to write {}", m_temporaryPath);
+    }
+    return written;
+}
+
+void PngStreamWriter::abort() {
+    if (m_streamInitialized) {
+        deflateEnd(&m_stream);
+        m_streamInitialized = false;
+    }
+    if (m_file) {
+        std::fclose(m_file);
+        m_file = nullptr;
+        std::remove(m_temporaryPath.c_str());
+    }
+}
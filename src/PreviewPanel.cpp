@@ -7,14 +7,21 @@
 
 #include "imgui/imgui.h"
 
+// Deepest zoom into the preview
+static const float MAX_PREVIEW_ZOOM = 64.0f;
+
 PreviewPanel::PreviewPanel(std::shared_ptr<ShaderManager> shaderManager)
     : m_shaderManager(shaderManager)
     , m_aspectMode(AspectMode::Fixed_16_9)
+    , m_previewPixelSize(0, 0)
+    , m_zoom(1.0f)
     , m_previewVAO(0)
     , m_previewVBO(0) {
     
     m_resolution[0] = 1920.0f; // Default 16:9 values, will be updated dynamically
     m_resolution[1] = 1080.0f;
+    m_viewCenter[0] = 0.5f;
+    m_viewCenter[1] = 0.5f;
 }
 
 PreviewPanel::~PreviewPanel() {
@@ -26,11 +33,11 @@ bool PreviewPanel::initialize() {
     return true;
 }
 
-void PreviewPanel::render(GLuint textureId, float time, float renderScaleFactor, std::pair<float, float> uvScale) {
-    renderPreviewPanel(textureId, time, renderScaleFactor, uvScale);
+void PreviewPanel::render(GLuint textureId, float time, float renderScaleFactor, std::pair<float, float> uvScale, float renderProgress) {
+    renderPreviewPanel(textureId, time, renderScaleFactor, uvScale, renderProgress);
 }
 
-void PreviewPanel::renderPreviewPanel(GLuint textureId, float time, float renderScaleFactor, std::pair<float, float> uvScale) {
+void PreviewPanel::renderPreviewPanel(GLuint textureId, float time, float renderScaleFactor, std::pair<float, float> uvScale, float renderProgress) {
     glClearColor(0.0f, 0.0f, 0.0f, 1.0f);
     glClear(GL_COLOR_BUFFER_BIT);
 
@@ -46,7 +53,40 @@ void PreviewPanel::renderPreviewPanel(GLuint textureId, float time, float render
         ImGui::SameLine();
         ImGui::TextColored(ImVec4(1.0f, 0.5f, 0.0f, 1.0f), "(Rendering at %.0f%%)", renderScaleFactor * 100.0f);
     }
+
+    // Display the zoom level with a way back to the full frame
+    if (isZoomed()) {
+        ImGui::SameLine();
+        ImGui::TextColored(ImVec4(0.5f, 0.8f, 1.0f, 1.0f), "(Zoom %.1fx)", m_zoom);
+        ImGui::SameLine();
+        if (ImGui::SmallButton("Reset Zoom")) {
+            resetView();
+        }
+    }
+
+    // A frame from the frame cache stands in while the current time is rendered
+    if (m_cacheStatus.showingCachedFrame) {
+        ImGui::SameLine();
+        ImGui::TextColored(ImVec4(0.5f, 1.0f, 0.6f, 1.0f), "(Cached)");
+    }
+
+    // Display chunk fill progress while the frame is still converging
+    if (renderProgress < 1.0f && !m_cacheStatus.showingCachedFrame) {
+        ImGui::SameLine();
+        char overlay[32];
+        snprintf(overlay, sizeof(overlay), "Filling %.0f%%", renderProgress * 100.0f);
+        ImGui::ProgressBar(renderProgress, ImVec2(120.0f, 0.0f), overlay);
+    }
     
+    if (m_cacheStatus.enabled) {
+        uint64_t lookups = m_cacheStatus.hits + m_cacheStatus.misses;
+        float hitRate = lookups > 0 ? 100.0f * static_cast<float>(m_cacheStatus.hits) / static_cast<float>(lookups) : 0.0f;
+        ImGui::SameLine();
+        ImGui::TextColored(ImVec4(0.7f, 0.7f, 0.7f, 1.0f), "Cache: %zu frames, %.0f/%.0f MB, %.0f%% hits",
+                           m_cacheStatus.frames, m_cacheStatus.memoryBytes / (1024.0 * 1024.0),
+                           m_cacheStatus.budgetBytes / (1024.0 * 1024.0), hitRate);
+    }
+
     ImGui::Separator();
     
     if (textureId != 0) {
@@ -55,6 +95,12 @@ void PreviewPanel::renderPreviewPanel(GLuint textureId, float time, float render
         availableSize.y -= 60; // Leave space for text above
         
         ImVec2 previewSize = calculatePreviewSize(availableSize);
+
+        ImVec2 framebufferScale = ImGui::GetIO().DisplayFramebufferScale;
+        m_previewPixelSize = {
+            std::max(1, static_cast<int>(previewSize.x * framebufferScale.x)),
+            std::max(1, static_cast<int>(previewSize.y * framebufferScale.y))
+        };
         
         // Calculate centering offset
         ImVec2 offset = ImVec2(
@@ -80,6 +126,25 @@ void PreviewPanel::renderPreviewPanel(GLuint textureId, float time, float render
         // Interaction
         ImGui::SetCursorScreenPos(imageStartPos);
         ImGui::InvisibleButton("##preview_input", previewSize);
+
+        if (ImGui::IsItemHovered()) {
+            ImVec2 mousePos = ImGui::GetMousePos();
+            ImVec2 rectMin = ImGui::GetItemRectMin();
+            ImVec2 rectSize = ImGui::GetItemRectSize();
+            ImGuiIO& io = ImGui::GetIO();
+
+            if (io.MouseWheel != 0.0f && rectSize.x > 0 && rectSize.y > 0) {
+                float u = (mousePos.x - rectMin.x) / rectSize.x;
+                float v = 1.0f - (mousePos.y - rectMin.y) / rectSize.y;
+                zoomAt(u, v, m_zoom * std::pow(1.25f, io.MouseWheel));
+            }
+
+            if (ImGui::IsMouseDragging(ImGuiMouseButton_Right) && rectSize.x > 0 && rectSize.y > 0) {
+                m_viewCenter[0] -= io.MouseDelta.x / rectSize.x / m_zoom;
+                m_viewCenter[1] += io.MouseDelta.y / rectSize.y / m_zoom;
+                clampView();
+            }
+        }
         
         if (ImGui::IsItemActive()) {
             ImVec2 mousePos = ImGui::GetMousePos();
@@ -92,6 +157,11 @@ void PreviewPanel::renderPreviewPanel(GLuint textureId, float time, float render
             // Actually, let's double check if we need to clamp.
             u = std::max(0.0f, std::min(1.0f, u));
             v = std::max(0.0f, std::min(1.0f, v));
+
+            // Mouse coordinates refer to the full image, not the zoomed region
+            PreviewViewRect view = getViewRect();
+            u = view.x + u * view.width;
+            v = view.y + v * view.height;
             
             m_shaderManager->setMousePosition(u, v);
             m_shaderManager->setMouseClickState(true);
@@ -104,8 +174,8 @@ void PreviewPanel::renderPreviewPanel(GLuint textureId, float time, float render
                 // Wait, if I move mouse UP (negative delta.y), I want my coords to go UP.
                 // In standard UV (0 at bottom), UP means INCREASING Y.
                 // So negative delta.y -> positive change in Y.
-                float dx = delta.x / rectSize.x;
-                float dy = -delta.y / rectSize.y;
+                float dx = delta.x / rectSize.x / m_zoom;
+                float dy = -delta.y / rectSize.y / m_zoom;
                 m_shaderManager->updateIntegratedMouse(dx, dy);
             }
 
@@ -118,6 +188,41 @@ void PreviewPanel::renderPreviewPanel(GLuint textureId, float time, float render
     }
 }
 
+PreviewViewRect PreviewPanel::getViewRect() const {
+    PreviewViewRect view;
+    view.width = 1.0f / m_zoom;
+    view.height = 1.0f / m_zoom;
+    view.x = m_viewCenter[0] - view.width * 0.5f;
+    view.y = m_viewCenter[1] - view.height * 0.5f;
+    return view;
+}
+
+void PreviewPanel::resetView() {
+    m_zoom = 1.0f;
+    m_viewCenter[0] = 0.5f;
+    m_viewCenter[1] = 0.5f;
+}
+
+void PreviewPanel::zoomAt(float u, float v, float zoom) {
+    zoom = std::max(1.0f, std::min(MAX_PREVIEW_ZOOM, zoom));
+
+    // Keep the point of the image under the cursor in place
+    PreviewViewRect view = getViewRect();
+    float pointX = view.x + u * view.width;
+    float pointY = view.y + v * view.height;
+
+    m_zoom = zoom;
+    m_viewCenter[0] = pointX + (0.5f - u) / m_zoom;
+    m_viewCenter[1] = pointY + (0.5f - v) / m_zoom;
+    clampView();
+}
+
+void PreviewPanel::clampView() {
+    float half = 0.5f / m_zoom;
+    m_viewCenter[0] = std::max(half, std::min(1.0f - half, m_viewCenter[0]));
+    m_viewCenter[1] = std::max(half, std::min(1.0f - half, m_viewCenter[1]));
+}
+
 ImVec2 PreviewPanel::calculatePreviewSize(ImVec2 availableSize) {
     if (m_aspectMode == AspectMode::Free) {
         return availableSize;
@@ -0,0 +1,453 @@
+#include "RenderCoordinator.h"
+#include "Logger.h"
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <csignal>
+#include <cstdio>
+#include <cstdlib>
+#include <filesystem>
+#include <thread>
+
+#include <fcntl.h>
+#include <poll.h>
+#include <spawn.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+extern char** environ;
+
+// Seconds between merged progress messages
+static const float PROGRESS_INTERVAL = 2.0f;
+
+// Split everything that arrived on the descriptor into lines. Waits up to timeoutMs
+// (-1 forever) for data. Returns false once the other side has closed it.
+static bool readLines(int fd, std::string& buffer, std::deque<std::string>& lines, int timeoutMs) {
+    pollfd descriptor = { fd, POLLIN, 0 };
+    int ready = poll(&descriptor, 1, timeoutMs);
+    if (ready <= 0) {
+        return ready == 0 || errno == EINTR;
+    }
+
+    char data[4096];
+    ssize_t count = read(fd, data, sizeof(data));
+    if (count < 0) {
+        return errno == EINTR || errno == EAGAIN;
+    }
+    if (count == 0) {
+        return false;
+    }
+    buffer.append(data, static_cast<size_t>(count));
+
+    size_t newline;
+    while ((newline = buffer.find('\n')) != std::string::npos) {
+        lines.push_back(buffer.substr(0, newline));
+        buffer.erase(0, newline + 1);
+    }
+    return true;
+}
+
+RenderCoordinator::RenderCoordinator(const std::string& executable, int workerCount)
+    : m_executable(executable)
+    , m_workerCount(workerCount)
+    , m_firstFrame(0)
+    , m_finishedCount(0) {
+    // Workers must run this very binary, whatever directory it was started from
+    std::error_code error;
+    std::filesystem::path self = std::filesystem::read_symlink("/proc/self/exe", error);
+    if (!error) {
+        m_executable = self.string();
+    }
+    if (m_workerCount <= 0) {
+        m_workerCount = std::max(1, static_cast<int>(std::thread::hardware_concurrency()));
+    }
+}
+
+RenderCoordinator::~RenderCoordinator() {
+    for (auto& worker : m_workers) {
+        closeWorker(worker);
+    }
+}
+
+bool RenderCoordinator::sendLine(int fd, const std::string& line) {
+    std::string data = line + "\n";
+    return fd >= 0 && write(fd, data.data(), data.size()) == static_cast<ssize_t>(data.size());
+}
+
+bool RenderCoordinator::spawnWorker(Worker& worker, const std::vector<std::string>& arguments) {
+    int commandPipe[2];
+    int progressPipe[2];
+    if (pipe2(commandPipe, O_CLOEXEC) != 0) {
+        return false;
+    }
+    if (pipe2(progressPipe, O_CLOEXEC) != 0) {
+        close(commandPipe[0]);
+        close(commandPipe[1]);
+        return false;
+    }
+
+    // Only the two pipe ends become stdin and stdout, everything else is close-on-exec.
+    // stderr is shared, so worker errors show up in the coordinator's output.
+    posix_spawn_file_actions_t actions;
+    posix_spawn_file_actions_init(&actions);
+    posix_spawn_file_actions_adddup2(&actions, commandPipe[0], STDIN_FILENO);
+    posix_spawn_file_actions_adddup2(&actions, progressPipe[1], STDOUT_FILENO);
+
+    std::vector<char*> argv;
+    for (const auto& argument : arguments) {
+        argv.push_back(const_cast<char*>(argument.c_str()));
+    }
+    argv.push_back(nullptr);
+
+    pid_t pid = -1;
+    int result = posix_spawn(&pid, m_executable.c_str(), &actions, nullptr, argv.data(), environ);
+    posix_spawn_file_actions_destroy(&actions);
+    close(commandPipe[0]);
+    close(progressPipe[1]);
+    if (result != 0) {
+        close(commandPipe[1]);
+        close(progressPipe[0]);
+        return false;
+    }
+
+    worker.pid = pid;
+    worker.commandFd = commandPipe[1];
+    worker.progressFd = progressPipe[0];
+    return true;
+}
+
+bool RenderCoordinator::renderSequence(const std::string& projectPath,
+                                       const HeadlessRenderer::SequenceOptions& options, bool debugMode) {
+    if (options.format != FrameEncoder::Format::Png) {
+        LOG_ERROR("Worker processes can only render PNG sequences, streams need a single process");
+        return false;
+    }
+
+    // A worker that dies must show up as a failed write, not terminate the coordinator
+    std::signal(SIGPIPE, SIG_IGN);
+
+    m_firstFrame = HeadlessRenderer::getFirstFrame(options);
+    int endFrame = HeadlessRenderer::getEndFrame(options);
+    int frameCount = endFrame - m_firstFrame;
+    m_queue.assign(1, { m_firstFrame, endFrame });
+    m_finished.assign(frameCount, 0);
+    m_finishedCount = 0;
+
+    // Encoder threads are shared out among the workers instead of each using every core
+    int workerCount = std::min(m_workerCount, frameCount);
+    int cores = std::max(1, static_cast<int>(std::thread::hardware_concurrency()));
+    int encodeThreads = options.encodeThreads > 0 ? options.encodeThreads : std::max(1, cores / workerCount);
+
+    std::vector<std::string> arguments = {
+        m_executable,
+        "--render-sequence",
+        std::to_string(options.startTime),
+        std::to_string(options.endTime),
+        std::to_string(options.fps),
+        std::to_string(options.width) + "x" + std::to_string(options.height),
+        options.output,
+        "--encode-threads",
+        std::to_string(encodeThreads),
+        "--sequence-worker"
+    };
+    if (debugMode) {
+        arguments.push_back("--debug");
+    }
+    arguments.push_back(projectPath);
+
+    m_workers.assign(workerCount, Worker());
+    for (auto& worker : m_workers) {
+        if (!spawnWorker(worker, arguments)) {
+            LOG_ERROR("Failed to start worker process {}", m_executable);
+            return false;
+        }
+    }
+    LOG_INFO("Rendering frames {} to {} with {} worker processes ({} encoder threads each)",
+             m_firstFrame, endFrame - 1, workerCount, encodeThreads);
+
+    bool workerFailed = false;
+    bool inputClosed = false;
+    auto startClock = std::chrono::steady_clock::now();
+    auto lastReport = startClock;
+
+    while (true) {
+        std::vector<pollfd> descriptors;
+        std::vector<Worker*> owners;
+        for (auto& worker : m_workers) {
+            if (worker.progressFd >= 0) {
+                descriptors.push_back({ worker.progressFd, POLLIN, 0 });
+                owners.push_back(&worker);
+            }
+        }
+        if (descriptors.empty()) {
+            break;
+        }
+
+        int ready = poll(descriptors.data(), descriptors.size(), 1000);
+        if (ready < 0 && errno != EINTR) {
+            LOG_ERROR("Waiting for the workers failed");
+            break;
+        }
+
+        for (size_t i = 0; ready > 0 && i < descriptors.size(); i++) {
+            if (descriptors[i].revents == 0) {
+                continue;
+            }
+            Worker& worker = *owners[i];
+            std::deque<std::string> lines;
+            bool open = readLines(worker.progressFd, worker.input, lines, 0);
+            for (const auto& line : lines) {
+                handleLine(worker, line);
+            }
+            if (open) {
+                continue;
+            }
+
+            // Whatever the worker had not finished goes back to the queue
+            if (worker.busy && worker.next < worker.end) {
+                m_queue.push_back({ worker.next, worker.end });
+            }
+            closeWorker(worker);
+            workerFailed = workerFailed || worker.failed;
+            for (auto& other : m_workers) {
+                if (other.stealingFrom == &worker) {
+                    other.stealingFrom = nullptr;
+                }
+            }
+            for (auto& other : m_workers) {
+                if (other.progressFd >= 0 && !other.busy && !other.stealingFrom && !other.limitPending && !inputClosed) {
+                    assignWork(other);
+                }
+            }
+        }
+
+        // Once nothing is queued or in progress, closing stdin lets the workers finish
+        bool active = !m_queue.empty();
+        for (const auto& worker : m_workers) {
+            active = active || (worker.progressFd >= 0 && (worker.busy || worker.stealingFrom));
+        }
+        if (!active && !inputClosed) {
+            for (auto& worker : m_workers) {
+                if (worker.commandFd >= 0) {
+                    close(worker.commandFd);
+                    worker.commandFd = -1;
+                }
+            }
+            inputClosed = true;
+        }
+
+        auto now = std::chrono::steady_clock::now();
+        if (std::chrono::duration<float>(now - lastReport).count() >= PROGRESS_INTERVAL) {
+            lastReport = now;
+            float seconds = std::chrono::duration<float>(now - startClock).count();
+            float rate = m_finishedCount / std::max(seconds, 0.001f);
+            int remaining = rate > 0.0f ? static_cast<int>((frameCount - m_finishedCount) / rate) : 0;
+            LOG_INFO("Rendered {}/{} frames ({} fps, about {}s left)",
+                     m_finishedCount, frameCount, static_cast<int>(rate * 10.0f) / 10.0f, remaining);
+        }
+    }
+
+    float seconds = std::chrono::duration<float>(std::chrono::steady_clock::now() - startClock).count();
+    if (workerFailed || m_finishedCount < frameCount) {
+        // Frames of a failed worker may still have been in its encoder, a second run
+        // renders exactly the files that are missing
+        LOG_ERROR("Rendered {} of {} frames but a worker process failed, run again to render the missing frames",
+                  m_finishedCount, frameCount);
+        return false;
+    }
+    LOG_IMPORTANT("Rendered {} frames to {} with {} worker processes in {}s",
+                  frameCount, options.output, workerCount, seconds);
+    return true;
+}
+
+void RenderCoordinator::assignWork(Worker& worker) {
+    if (!m_queue.empty()) {
+        // Guided chunks: large while there is plenty left, down to single frames at the
+        // end, so the last frames are spread over every worker
+        std::pair<int, int>& range = m_queue.front();
+        int chunk = std::max(1, (range.second - range.first) / (2 * static_cast<int>(m_workers.size())));
+        worker.next = range.first;
+        worker.end = std::min(range.second, range.first + chunk);
+        range.first = worker.end;
+        if (range.first >= range.second) {
+            m_queue.pop_front();
+        }
+        worker.busy = sendLine(worker.commandFd,
+                               "range " + std::to_string(worker.next) + " " + std::to_string(worker.end));
+        return;
+    }
+
+    // Nothing queued: take over the back half of the largest range not started yet.
+    // The frame at next is in progress and stays with its worker.
+    Worker* victim = nullptr;
+    int victimLeft = 0;
+    for (auto& other : m_workers) {
+        int left = other.end - other.next - 1;
+        bool stealable = other.busy && other.progressFd >= 0 && !other.limitPending;
+        if (stealable && left > victimLeft) {
+            victim = &other;
+            victimLeft = left;
+        }
+    }
+    if (!victim) {
+        return;
+    }
+
+    // The victim confirms where it actually stops, which may be later than asked for if
+    // it got there first, so no frame is ever rendered twice
+    int split = victim->end - (victimLeft + 1) / 2;
+    worker.stealEnd = victim->end;
+    worker.stealingFrom = victim;
+    victim->limitPending = true;
+    if (!sendLine(victim->commandFd, "limit " + std::to_string(split))) {
+        worker.stealingFrom = nullptr;
+        victim->limitPending = false;
+    }
+}
+
+bool RenderCoordinator::handleLine(Worker& worker, const std::string& line) {
+    if (line.rfind("frame ", 0) == 0) {
+        int frame = std::atoi(line.c_str() + 6);
+        int index = frame - m_firstFrame;
+        if (index >= 0 && index < static_cast<int>(m_finished.size()) && !m_finished[index]) {
+            m_finished[index] = 1;
+            m_finishedCount++;
+        }
+        worker.next = std::max(worker.next, frame + 1);
+        return true;
+    }
+
+    if (line == "idle") {
+        // With a limit outstanding, new work waits for the reply, which refers to the
+        // range that just ended
+        worker.busy = false;
+        if (!worker.stealingFrom && !worker.limitPending) {
+            assignWork(worker);
+        }
+        return true;
+    }
+
+    if (line.rfind("limited ", 0) == 0) {
+        int stop = std::atoi(line.c_str() + 8);
+        worker.limitPending = false;
+        if (worker.busy) {
+            worker.end = std::min(worker.end, stop);
+        }
+
+        for (auto& thief : m_workers) {
+            if (thief.stealingFrom != &worker) {
+                continue;
+            }
+            thief.stealingFrom = nullptr;
+            if (stop < thief.stealEnd) {
+                LOG_DEBUG("Worker {} takes frames {} to {} over from worker {}",
+                          thief.pid, stop, thief.stealEnd - 1, worker.pid);
+                thief.next = stop;
+                thief.end = thief.stealEnd;
+                thief.busy = sendLine(thief.commandFd,
+                                      "range " + std::to_string(thief.next) + " " + std::to_string(thief.end));
+            } else {
+                assignWork(thief);
+            }
+        }
+        if (!worker.busy && !worker.stealingFrom) {
+            assignWork(worker);
+        }
+        return true;
+    }
+
+    LOG_WARN("Unexpected message from worker {}: {}", worker.pid, line);
+    return false;
+}
+
+void RenderCoordinator::closeWorker(Worker& worker) {
+    if (worker.commandFd >= 0) {
+        close(worker.commandFd);
+        worker.commandFd = -1;
+    }
+    if (worker.progressFd >= 0) {
+        close(worker.progressFd);
+        worker.progressFd = -1;
+    }
+    worker.busy = false;
+    worker.limitPending = false;
+
+    if (worker.pid > 0) {
+        int status = 0;
+        waitpid(worker.pid, &status, 0);
+        worker.failed = !WIFEXITED(status) || WEXITSTATUS(status) != 0;
+        if (worker.failed) {
+            LOG_ERROR("Worker process {} failed", worker.pid);
+        }
+        worker.pid = -1;
+    }
+}
+
+bool RenderCoordinator::runWorker(const std::string& projectPath, const HeadlessRenderer::SequenceOptions& options) {
+    HeadlessRenderer renderer;
+    if (!renderer.initialize() || !renderer.beginSequence(projectPath, options)) {
+        return false;
+    }
+
+    std::string buffer;
+    std::deque<std::string> lines;
+    int rangeEnd = 0;
+    bool succeeded = true;
+    sendLine(STDOUT_FILENO, "idle");
+
+    // A limit can arrive before the range it applies to was started or after it ended,
+    // the reply always tells the coordinator where this worker really stops
+    auto applyLimit = [&rangeEnd](const std::string& line, int nextFrame) {
+        int limit = std::atoi(line.c_str() + 6);
+        rangeEnd = std::max(std::min(rangeEnd, limit), nextFrame);
+        sendLine(STDOUT_FILENO, "limited " + std::to_string(rangeEnd));
+    };
+
+    while (succeeded) {
+        if (lines.empty() && !readLines(STDIN_FILENO, buffer, lines, -1)) {
+            break;
+        }
+        if (lines.empty()) {
+            continue;
+        }
+        std::string command = lines.front();
+        lines.pop_front();
+
+        if (command.rfind("limit ", 0) == 0) {
+            applyLimit(command, rangeEnd);
+            continue;
+        }
+        if (command.rfind("range ", 0) != 0) {
+            LOG_WARN("Unexpected command from the coordinator: {}", command);
+            continue;
+        }
+
+        int frame = 0;
+        if (std::sscanf(command.c_str(), "range %d %d", &frame, &rangeEnd) != 2) {
+            continue;
+        }
+        for (; frame < rangeEnd; frame++) {
+            // Limits are the only commands sent while a range is in progress
+            readLines(STDIN_FILENO, buffer, lines, 0);
+            while (!lines.empty() && lines.front().rfind("limit ", 0) == 0) {
+                applyLimit(lines.front(), frame);
+                lines.pop_front();
+            }
+            if (frame >= rangeEnd) {
+                break;
+            }
+
+            bool skipped = false;
+            if (!renderer.renderSequenceFrame(frame, skipped)) {
+                succeeded = false;
+                break;
+            }
+            sendLine(STDOUT_FILENO, "frame " + std::to_string(frame));
+        }
+        if (succeeded) {
+            sendLine(STDOUT_FILENO, "idle");
+        }
+    }
+
+    return renderer.finishSequence() && succeeded;
+}
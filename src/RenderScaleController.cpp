@@ -0,0 +1,140 @@
+#include "RenderScaleController.h"
+#include "Timeline.h"
+#include <algorithm>
+#include <cmath>
+
+RenderScaleController::RenderScaleController() {
+}
+
+float RenderScaleController::addSample(const std::string& passName, float gpuMilliseconds, int width, int height, float pixelFraction) {
+    if (width <= 0 || height <= 0 || pixelFraction <= 0.0f) {
+        return getCurrentCostPerMegapixel();
+    }
+
+    auto& cost = m_passCosts[passName];
+    float fullResolutionMs = gpuMilliseconds / pixelFraction;
+    cost.fullResolutionMs = (cost.fullResolutionMs <= 0.0f) ? fullResolutionMs : cost.fullResolutionMs * 0.5f + fullResolutionMs * 0.5f;
+    cost.megapixels = static_cast<float>(width) * static_cast<float>(height) / 1.0e6f;
+
+    return getCurrentCostPerMegapixel();
+}
+
+void RenderScaleController::predictPassScales(const Timeline& timeline, std::vector<PassScale>& passes, float budgetMs) const {
+    float costFactor = getLookaheadCostFactor(timeline);
+
+    // Pinned passes are paid for first, the rest of the budget goes to the other passes
+    std::vector<PassScale*> scaledPasses;
+    std::vector<float> costs;
+    float remainingMs = budgetMs;
+    for (auto& pass : passes) {
+        auto it = m_passCosts.find(pass.name);
+        bool measured = it != m_passCosts.end() && it->second.fullResolutionMs > 0.0f;
+        if (pass.pinned) {
+            pass.scale = MAX_SCALE;
+            if (measured) {
+                remainingMs -= it->second.fullResolutionMs * costFactor;
+            }
+        } else if (measured) {
+            scaledPasses.push_back(&pass);
+            costs.push_back(it->second.fullResolutionMs * costFactor);
+        }
+    }
+    if (scaledPasses.empty()) {
+        return;
+    }
+    remainingMs = std::max(0.0f, remainingMs);
+
+    // The cost of a pass is proportional to scale^2. Keeping the total resolution loss
+    // (the sum of 1 - scale) minimal within the budget gives scale = min(1, k / cost):
+    // cheap passes stay at full resolution and the expensive ones absorb the reduction.
+    // The frame cost grows with k, so k is found by bisection.
+    auto scaleFor = [](float k, float cost) {
+        return std::clamp(k / cost, MIN_SCALE, MAX_SCALE);
+    };
+    auto frameCost = [&](float k) {
+        float totalMs = 0.0f;
+        for (float cost : costs) {
+            float scale = scaleFor(k, cost);
+            totalMs += cost * scale * scale;
+        }
+        return totalMs;
+    };
+
+    float k = *std::max_element(costs.begin(), costs.end());
+    if (frameCost(k) > remainingMs) {
+        float low = 0.0f;
+        float high = k;
+        for (int i = 0; i < 32; i++) {
+            float mid = (low + high) * 0.5f;
+            if (frameCost(mid) > remainingMs) {
+                high = mid;
+            } else {
+                low = mid;
+            }
+        }
+        k = low;
+    }
+
+    for (size_t i = 0; i < scaledPasses.size(); i++) {
+        PassScale& pass = *scaledPasses[i];
+        float scale = scaleFor(k, costs[i]);
+
+        // Drop immediately, but recover gradually to avoid oscillating around the budget
+        if (scale > pass.scale) {
+            scale = std::min(scale, pass.scale + SCALE_UP_STEP);
+        }
+        pass.scale = scale;
+    }
+}
+
+float RenderScaleController::getLookaheadCostFactor(const Timeline& timeline) const {
+    float currentCost = getCurrentCostPerMegapixel();
+    if (currentCost <= 0.0f) {
+        return 1.0f;
+    }
+
+    // Cost of the current position, falling back to the latest measurements
+    float costPerMegapixel = timeline.getCostPerMegapixel(timeline.getCurrentTime());
+    if (costPerMegapixel < 0.0f) {
+        costPerMegapixel = currentCost;
+    }
+
+    // While playing, plan for the most expensive slice that will be reached before
+    // measurements of the upcoming frames can arrive
+    if (timeline.isPlaying()) {
+        float sliceDuration = timeline.getTimeSliceDuration();
+        float lookahead = LOOKAHEAD_SECONDS * timeline.getPlaybackSpeed();
+        for (float offset = sliceDuration; offset <= lookahead; offset += sliceDuration) {
+            float time = timeline.getCurrentTime() + offset;
+            if (time >= timeline.getDuration()) {
+                if (!timeline.isLooping()) break;
+                time = std::fmod(time, timeline.getDuration());
+            }
+            costPerMegapixel = std::max(costPerMegapixel, timeline.getCostPerMegapixel(time));
+        }
+    }
+
+    // Per-pass costs only reflect the latest measurements, the timeline slices scale them
+    return costPerMegapixel > 0.0f ? costPerMegapixel / currentCost : 1.0f;
+}
+
+void RenderScaleController::reset() {
+    m_passCosts.clear();
+}
+
+float RenderScaleController::getCurrentCostPerMegapixel() const {
+    float totalMs = 0.0f;
+    for (const auto& [name, cost] : m_passCosts) {
+        totalMs += cost.fullResolutionMs;
+    }
+    float megapixels = getTotalMegapixels();
+    return megapixels > 0.0f ? totalMs / megapixels : -1.0f;
+}
+
+float RenderScaleController::getTotalMegapixels() const {
+    float megapixels = 0.0f;
+    for (const auto& [name, cost] : m_passCosts) {
+        megapixels += cost.megapixels;
+    }
+    return megapixels;
+}
@@ -0,0 +1,227 @@
+#include "RenderThread.h"
+#include "ShaderManager.h"
+#include "Logger.h"
+#include "glad.h"
+#include <GLFW/glfw3.h>
+
+RenderThread::RenderThread(std::shared_ptr<ShaderManager> shaderManager)
+    : m_shaderManager(shaderManager)
+    , m_window(nullptr)
+    , m_hasJob(false)
+    , m_stopRequested(false)
+    , m_writeIndex(0)
+    , m_readyIndex(1)
+    , m_displayIndex(2)
+    , m_readyIsNew(false)
+    , m_readFbo(0)
+    , m_drawFbo(0) {
+}
+
+RenderThread::~RenderThread() {
+    stop();
+}
+
+bool RenderThread::start(GLFWwindow* sharedWindow) {
+    if (isRunning()) {
+        return true;
+    }
+
+    // GLFW windows can only be created on the main thread, so the hidden window that
+    // carries the render context is created here and only made current on the thread
+    glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 3);
+    glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 3);
+    glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
+    glfwWindowHint(GLFW_VISIBLE, GLFW_FALSE);
+    m_window = glfwCreateWindow(1, 1, "Fork Eater Render Thread", nullptr, sharedWindow);
+    glfwWindowHint(GLFW_VISIBLE, GLFW_TRUE);
+
+    if (!m_window) {
+        LOG_ERROR("Failed to create render thread context");
+        return false;
+    }
+
+    m_stopRequested = false;
+    m_thread = std::thread(&RenderThread::threadMain, this);
+    LOG_INFO("Render thread started");
+    return true;
+}
+
+void RenderThread::stop() {
+    if (m_thread.joinable()) {
+        {
+            std::lock_guard<std::mutex> lock(m_jobMutex);
+            m_stopRequested = true;
+        }
+        m_jobCondition.notify_one();
+        m_thread.join();
+        LOG_INFO("Render thread stopped");
+    }
+
+    if (m_window) {
+        glfwDestroyWindow(m_window);
+        m_window = nullptr;
+    }
+}
+
+void RenderThread::submit(Job job, const std::string& presentPass) {
+    {
+        std::lock_guard<std::mutex> lock(m_jobMutex);
+        m_pendingJob = std::move(job);
+        m_pendingPresentPass = presentPass;
+        m_hasJob = true;
+    }
+    m_jobCondition.notify_one();
+}
+
+RenderThread::Frame RenderThread::acquireLatestFrame() {
+    {
+        std::lock_guard<std::mutex> lock(m_slotMutex);
+        if (m_readyIsNew) {
+            // The slot handed back may still be read by previously submitted UI draws
+            Slot& released = m_slots[m_displayIndex];
+            if (released.releasedFence) {
+                glDeleteSync(released.releasedFence);
+            }
+            released.releasedFence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+            glFlush();
+
+            std::swap(m_displayIndex, m_readyIndex);
+            m_readyIsNew = false;
+        }
+    }
+
+    Slot& slot = m_slots[m_displayIndex];
+    if (slot.renderedFence) {
+        glWaitSync(slot.renderedFence, 0, GL_TIMEOUT_IGNORED);
+        glDeleteSync(slot.renderedFence);
+        slot.renderedFence = nullptr;
+    }
+
+    Frame frame;
+    frame.textureId = slot.textureId;
+    frame.width = slot.width;
+    frame.height = slot.height;
+    frame.uvScale = slot.uvScale;
+    return frame;
+}
+
+void RenderThread::threadMain() {
+    glfwMakeContextCurrent(m_window);
+    glGenFramebuffers(1, &m_readFbo);
+    glGenFramebuffers(1, &m_drawFbo);
+
+    while (true) {
+        Job job;
+        std::string presentPass;
+        {
+            std::unique_lock<std::mutex> lock(m_jobMutex);
+            m_jobCondition.wait(lock, [this]() { return m_hasJob || m_stopRequested; });
+            if (m_stopRequested) {
+                break;
+            }
+            job = std::move(m_pendingJob);
+            presentPass = m_pendingPresentPass;
+            m_hasJob = false;
+        }
+
+        // Only issue the pass draws while holding the lock. Framebuffers are only resized
+        // or destroyed on this thread, so the copy and the wait for the GPU happen outside it.
+        bool present = false;
+        GLuint sourceTexture = 0;
+        std::pair<int, int> size;
+        std::pair<float, float> uvScale;
+        {
+            std::lock_guard<std::recursive_mutex> lock(m_shaderManager->getMutex());
+            bool drawn = job();
+            if (drawn || presentPass != m_lastPresentedPass) {
+                sourceTexture = m_shaderManager->getFramebufferTexture(presentPass);
+                size = m_shaderManager->getFramebufferSize(presentPass);
+                uvScale = m_shaderManager->getFramebufferUVScale(presentPass);
+                present = true;
+            }
+        }
+
+        if (present && copyToWriteSlot(sourceTexture, size.first, size.second)) {
+            m_slots[m_writeIndex].uvScale = uvScale;
+            m_lastPresentedPass = presentPass;
+            publishWriteSlot();
+        }
+    }
+
+    for (auto& slot : m_slots) {
+        if (slot.renderedFence) glDeleteSync(slot.renderedFence);
+        if (slot.releasedFence) glDeleteSync(slot.releasedFence);
+        if (slot.textureId != 0) glDeleteTextures(1, &slot.textureId);
+        slot = Slot();
+    }
+    glDeleteFramebuffers(1, &m_readFbo);
+    glDeleteFramebuffers(1, &m_drawFbo);
+    glfwMakeContextCurrent(nullptr);
+}
+
+bool RenderThread::copyToWriteSlot(GLuint sourceTexture, int width, int height) {
+    if (sourceTexture == 0 || width <= 0 || height <= 0) {
+        return false;
+    }
+
+    Slot& slot = m_slots[m_writeIndex];
+    if (slot.renderedFence) {
+        // Left over from a frame the UI skipped
+        glDeleteSync(slot.renderedFence);
+        slot.renderedFence = nullptr;
+    }
+    if (slot.releasedFence) {
+        glWaitSync(slot.releasedFence, 0, GL_TIMEOUT_IGNORED);
+        glDeleteSync(slot.releasedFence);
+        slot.releasedFence = nullptr;
+    }
+
+    if (slot.textureId == 0) {
+        glGenTextures(1, &slot.textureId);
+        glBindTexture(GL_TEXTURE_2D, slot.textureId);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+    }
+    // Blits can't convert between float and normalized formats, so the slot uses the
+    // format of the pass (passes with float outputs)
+    GLint format = GL_RGB8;
+    glBindTexture(GL_TEXTURE_2D, sourceTexture);
+    glGetTexLevelParameteriv(GL_TEXTURE_2D, 0, GL_TEXTURE_INTERNAL_FORMAT, &format);
+    if (slot.width != width || slot.height != height || slot.format != format) {
+        glBindTexture(GL_TEXTURE_2D, slot.textureId);
+        glTexImage2D(GL_TEXTURE_2D, 0, format, width, height, 0, GL_RGB, GL_UNSIGNED_BYTE, nullptr);
+        slot.width = width;
+        slot.height = height;
+        slot.format = format;
+    }
+    glBindTexture(GL_TEXTURE_2D, 0);
+
+    glBindFramebuffer(GL_READ_FRAMEBUFFER, m_readFbo);
+    glFramebufferTexture2D(GL_READ_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, sourceTexture, 0);
+    glBindFramebuffer(GL_DRAW_FRAMEBUFFER, m_drawFbo);
+    glFramebufferTexture2D(GL_DRAW_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, slot.textureId, 0);
+    glBlitFramebuffer(0, 0, width, height, 0, 0, width, height, GL_COLOR_BUFFER_BIT, GL_NEAREST);
+    glBindFramebuffer(GL_FRAMEBUFFER, 0);
+    return true;
+}
+
+void RenderThread::publishWriteSlot() {
+    Slot& slot = m_slots[m_writeIndex];
+    slot.renderedFence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+    glFlush();
+
+    // Block this thread (never the UI) until the frame is complete, so the UI only ever
+    // picks up finished frames
+    while (glClientWaitSync(slot.renderedFence, 0, 10 * 1000 * 1000) == GL_TIMEOUT_EXPIRED) {
+        std::lock_guard<std::mutex> lock(m_jobMutex);
+        if (m_stopRequested) {
+            return;
+        }
+    }
+
+    std::lock_guard<std::mutex> lock(m_slotMutex);
+    std::swap(m_writeIndex, m_readyIndex);
+    m_readyIsNew = true;
+}
@@ -234,6 +234,83 @@ void Settings::setRenderScaleMode(RenderScaleMode mode) {
     }
 }
 
+void Settings::setFrameBudgetMs(float budgetMs) {
+    budgetMs = std::max(1.0f, std::min(1000.0f, budgetMs));
+    if (std::abs(m_frameBudgetMs - budgetMs) > 0.01f) {
+        m_frameBudgetMs = budgetMs;
+        save();
+        if (onSettingsChanged) onSettingsChanged();
+    }
+}
+
+void Settings::setFrameCacheMemoryMB(int megabytes) {
+    megabytes = std::max(0, std::min(16384, megabytes));
+    if (m_frameCacheMemoryMB != megabytes) {
+        m_frameCacheMemoryMB = megabytes;
+        save();
+        if (onSettingsChanged) onSettingsChanged();
+    }
+}
+
+void Settings::setTimelineThumbnails(bool enabled) {
+    if (m_timelineThumbnails != enabled) {
+        m_timelineThumbnails = enabled;
+        save();
+        if (onSettingsChanged) onSettingsChanged();
+    }
+}
+
+void Settings::setRenderThreadEnabled(bool enabled) {
+    if (m_renderThreadEnabled != enabled) {
+        m_renderThreadEnabled = enabled;
+        save();
+        if (onSettingsChanged) onSettingsChanged();
+    }
+}
+
+void Settings::setChunkMethod(ChunkMethod method) {
+    if (m_chunkMethod != method) {
+        m_chunkMethod = method;
+        save();
+        // The stipple method is compiled into the shaders
+        if (onRenderScaleModeChanged) onRenderScaleModeChanged();
+        if (onSettingsChanged) onSettingsChanged();
+    }
+}
+
+void Settings::setUpscaleFilter(UpscaleFilter filter) {
+    if (m_upscaleFilter != filter) {
+        m_upscaleFilter = filter;
+        save();
+        if (onSettingsChanged) onSettingsChanged();
+    }
+}
+
+void Settings::setRenderAtPreviewSize(bool enabled) {
+    if (m_renderAtPreviewSize != enabled) {
+        m_renderAtPreviewSize = enabled;
+        save();
+        if (onSettingsChanged) onSettingsChanged();
+    }
+}
+
+void Settings::setTileBudgetMs(float budgetMs) {
+    budgetMs = std::max(1.0f, std::min(100.0f, budgetMs));
+    if (std::abs(m_tileBudgetMs - budgetMs) > 0.01f) {
+        m_tileBudgetMs = budgetMs;
+        save();
+        if (onSettingsChanged) onSettingsChanged();
+    }
+}
+
+void Settings::setAdaptiveRefresh(bool enabled) {
+    if (m_adaptiveRefresh != enabled) {
+        m_adaptiveRefresh = enabled;
+        save();
+        if (onSettingsChanged) onSettingsChanged();
+    }
+}
+
 void Settings::loadFromFile() {
     std::string settingsPath = getSettingsPath();
     
@@ -301,6 +378,46 @@ void Settings::loadFromFile() {
         if (settings.count("low_fps_render_treshold_25")) {
             m_lowFPSRenderThreshold25 = std::stof(settings["low_fps_render_treshold_25"]);
         }
+
+        if (settings.count("frame_budget_ms")) {
+            m_frameBudgetMs = std::stof(settings["frame_budget_ms"]);
+        }
+
+        if (settings.count("tile_budget_ms")) {
+            m_tileBudgetMs = std::stof(settings["tile_budget_ms"]);
+        }
+
+        if (settings.count("adaptive_refresh")) {
+            m_adaptiveRefresh = settings["adaptive_refresh"] == "1";
+        }
+
+        if (settings.count("render_thread")) {
+            m_renderThreadEnabled = settings["render_thread"] == "1";
+        }
+
+        if (settings.count("frame_cache_mb")) {
+            m_frameCacheMemoryMB = std::stoi(settings["frame_cache_mb"]);
+        }
+
+        if (settings.count("timeline_thumbnails")) {
+            m_timelineThumbnails = settings["timeline_thumbnails"] == "1";
+        }
+
+        if (settings.count("render_at_preview_size")) {
+            m_renderAtPreviewSize = settings["render_at_preview_size"] == "1";
+        }
+
+        if (settings.count("chunk_method")) {
+            std::string method = settings["chunk_method"];
+            if (method == "stipple") m_chunkMethod = ChunkMethod::Stipple;
+            else if (method == "scatter") m_chunkMethod = ChunkMethod::Scatter;
+        }
+
+        if (settings.count("upscale_filter")) {
+            std::string filter = settings["upscale_filter"];
+            if (filter == "bilinear") m_upscaleFilter = UpscaleFilter::Bilinear;
+            else if (filter == "lanczos") m_upscaleFilter = UpscaleFilter::Lanczos;
+        }
         
         LOG_INFO("Loaded settings from: {}", settingsPath);
         
@@ -344,6 +461,17 @@ void Settings::saveToFile() {
         file << "high_fps_treshold=" << m_highFPSThreshold << "\n";
         file << "low_fps_render_treshold_50=" << m_lowFPSRenderThreshold50 << "\n";
         file << "low_fps_render_treshold_25=" << m_lowFPSRenderThreshold25 << "\n";
+        file << "frame_budget_ms=" << m_frameBudgetMs << "\n";
+        file << "tile_budget_ms=" << m_tileBudgetMs << "\n";
+        file << "adaptive_refresh=" << (m_adaptiveRefresh ? 1 : 0) << "\n";
+        file << "render_thread=" << (m_renderThreadEnabled ? 1 : 0) << "\n";
+        file << "render_at_preview_size=" << (m_renderAtPreviewSize ? 1 : 0) << "\n";
+        file << "frame_cache_mb=" << m_frameCacheMemoryMB << "\n";
+        file << "timeline_thumbnails=" << (m_timelineThumbnails ? 1 : 0) << "\n";
+        file << "# Chunk method: stipple, scatter\n";
+        file << "chunk_method=" << (m_chunkMethod == ChunkMethod::Scatter ? "scatter" : "stipple") << "\n";
+        file << "# Upscale filter: bilinear, lanczos\n";
+        file << "upscale_filter=" << (m_upscaleFilter == UpscaleFilter::Lanczos ? "lanczos" : "bilinear") << "\n";
         
         LOG_INFO("Saved settings to: {}", settingsPath);
         
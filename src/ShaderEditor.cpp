@@ -8,6 +8,11 @@
 #include "ParameterPanel.h"
 
 #include "Timeline.h"
+#include "RenderScaleController.h"
+#include "RenderThread.h"
+#include "FrameReadback.h"
+#include "SharedFrameOutput.h"
+#include "TimelineThumbnails.h"
 #include "ShortcutManager.h"
 #include "ShaderProject.h"
 #include "Logger.h"
@@ -15,8 +20,10 @@
 #include "glad.h"
 #include <filesystem>
 #include <chrono>
+#include <thread>
 #include <iomanip>
 #include <algorithm>
+#include <cmath>
 
 #include <GLFW/glfw3.h>
 #include <iostream>
@@ -29,6 +36,9 @@ ShaderEditor::ShaderEditor(std::shared_ptr<ShaderManager> shaderManager,
                            std::shared_ptr<FileWatcher> fileWatcher)
     : m_shaderManager(shaderManager)
     , m_fileWatcher(fileWatcher)
+    , m_frameCacheHit(false)
+    , m_frameCacheTexture(0)
+    , m_showingCachedFrame(false)
     , m_leftPanelWidth(300.0f)
 
     , m_timelineHeight(65.0f) 
@@ -38,8 +48,9 @@ ShaderEditor::ShaderEditor(std::shared_ptr<ShaderManager> shaderManager,
     , m_screenWidth(1280)
     , m_screenHeight(720)
     , m_renderScaleFactor(1.0f)
-    , m_framesAboveHighThreshold(0)
-    , m_framesBelowLowThreshold(0) {
+    , m_previewRenderSize(0, 0)
+    , m_previewPendingSize(0, 0)
+    , m_previewSettleFrames(0) {
     
     // Create component classes
     m_previewPanel = std::make_unique<PreviewPanel>(m_shaderManager);
@@ -49,8 +60,20 @@ ShaderEditor::ShaderEditor(std::shared_ptr<ShaderManager> shaderManager,
     m_fileManager = std::make_unique<FileManager>(m_shaderManager, m_fileWatcher);
 
     m_timeline = std::make_unique<Timeline>();
+    m_scaleController = std::make_unique<RenderScaleController>();
     m_shortcutManager = std::make_unique<ShortcutManager>();
     m_currentProject = std::make_shared<ShaderProject>();
+    m_frameReadback = std::make_unique<FrameReadback>();
+
+    // Complete frames are read back into the cache, which compresses them on its own thread
+    m_frameCache = std::make_unique<FrameCache>(static_cast<size_t>(Settings::getInstance().getFrameCacheMemoryMB()) * 1024 * 1024);
+    FrameCache* cache = m_frameCache.get();
+    m_frameCacheReadback = std::make_unique<FrameReadback>([cache](const FrameReadback::MappedFrame& frame) {
+        cache->store(frame.tag, frame.width, frame.height, frame.pixels);
+        return true;
+    });
+
+    m_thumbnails = std::make_unique<TimelineThumbnails>(m_shaderManager);
 }
 
 void ShaderEditor::setScreenSize(int width, int height) {
@@ -59,115 +82,132 @@ void ShaderEditor::setScreenSize(int width, int height) {
 }
 
 void ShaderEditor::render() {
+    // Shader state is shared with the render thread (if enabled) for the whole UI frame
+    std::unique_lock<std::recursive_mutex> shaderLock(m_shaderManager->getMutex());
+
+    // Hand screenshots whose pixels have arrived over to the writer thread
+    m_frameReadback->poll();
+    if (m_sharedReadback) {
+        m_sharedReadback->poll();
+    }
+    m_frameCacheReadback->poll();
+
+    size_t cacheBudget = static_cast<size_t>(Settings::getInstance().getFrameCacheMemoryMB()) * 1024 * 1024;
+    if (m_frameCache->getStats().budgetBytes != cacheBudget) {
+        m_frameCache->setBudget(cacheBudget);
+    }
+
     // Process any pending shader reloads on the main thread
     processPendingReloads();
     processProjectReload();
+
+    // Choose the render scale and target size for this frame before any pass is rendered
+    updateRenderScale();
+    updatePreviewRenderSize();
     
     // Render all passes to their framebuffers
     if (m_currentProject) {
-        const auto& passes = m_currentProject->getPasses();
-        for (const auto& pass : passes) {
-            if (pass.enabled) {
-                int width, height;
-                auto it = m_passOutputSizes.find(pass.name);
-                if (it != m_passOutputSizes.end()) {
-                    width = it->second.first;
-                    height = it->second.second;
-                } else {
-                    width = m_screenWidth;
-                    height = m_screenHeight;
-                }
+        std::vector<PassRenderInfo> passes = collectPassRenderInfo(false);
+        float time = m_timeline->getCurrentTime();
+        RenderScaleMode scaleMode = getEffectiveRenderScaleMode();
 
-                // Determine effective render scale mode
-                RenderScaleMode settingMode = Settings::getInstance().getRenderScaleMode();
-                RenderScaleMode effectiveMode = settingMode;
-                if (settingMode == RenderScaleMode::Auto) {
-                    effectiveMode = m_timeline->isPlaying() ? RenderScaleMode::Resolution : RenderScaleMode::Chunk;
-                }
+        // Only the previewed pass is zoomed
+        std::string viewPass = m_selectedShader;
+        PreviewViewRect view = m_previewPanel->getViewRect();
 
-                auto startTime = glfwGetTime();
-                m_shaderManager->renderToFramebuffer(pass.name, width, height, m_timeline->getCurrentTime(), m_renderScaleFactor, effectiveMode);
-                glFinish(); // Wait for GPU to finish
-                auto endTime = glfwGetTime();
-                auto duration = endTime - startTime;
+        std::string sharedPass = m_sharedOutputPass;
 
-                float currentFPS = (duration > 1e-6) ? (1.0f / static_cast<float>(duration)) : 0.0f;
-                
-                std::stringstream ss;
-                ss << "Frame Duration: " << std::fixed << std::setprecision(4) << duration << "s, Current FPS: " << std::setprecision(2) << currentFPS;
-                LOG_DEBUG(ss.str());
-
-                float lastRenderScaleFactor = m_renderScaleFactor;
+        // Complete frames of the previewed pass are cached by timeline slice. Tiled frames
+        // are never complete at one time.
+        PassRenderInfo cachePass{};
+        bool cacheFrames = false;
+        for (const auto& pass : passes) {
+            if (pass.name == m_selectedShader) {
+                cachePass = pass;
+                cacheFrames = scaleMode != RenderScaleMode::Tiled && m_frameCache->isEnabled();
+            }
+        }
+        int cacheSlice = static_cast<int>(std::floor(time / m_timeline->getTimeSliceDuration()));
+        float cacheQuality = scaleMode == RenderScaleMode::Chunk ? 1.0f : cachePass.scale;
+
+        // While paused, the cached frame of the current slice stands in for the preview
+        // when scrubbing and while the exact frame is still filling in. Scrubbing over
+        // cached frames renders nothing at all.
+        m_showingCachedFrame = false;
+        bool skipRender = false;
+        if (cacheFrames && !m_timeline->isPlaying()) {
+            bool scrubbing = m_timeline->isScrubbing();
+            bool filling = m_shaderManager->getRenderProgress(cachePass.name) < 1.0f;
+            FrameCache::Key key{ cachePass.name, cacheSlice,
+                                 m_shaderManager->computeFrameFingerprint(cachePass.name, cachePass.width, cachePass.height) };
+            if ((scrubbing || filling) && lookupCachedFrame(key)) {
+                m_showingCachedFrame = true;
+                skipRender = scrubbing;
+            }
+        }
 
-                // Add to history and maintain size
-                m_fpsHistory.push_back(currentFPS);
-                if (m_fpsHistory.size() > 10) { // Average over last 10 frames
-                    m_fpsHistory.pop_front();
-                }
+        // Thumbnails of the previewed pass get the part of the frame budget the passes did
+        // not use in their last measured frame, or all of it when nothing was drawn
+        bool thumbnails = Settings::getInstance().getTimelineThumbnails();
+        std::vector<TimelineThumbnails::Pass> thumbnailPasses;
+        float frameBudgetMs = Settings::getInstance().getFrameBudgetMs();
+        float leftoverMs = frameBudgetMs;
+        for (const auto& pass : passes) {
+            thumbnailPasses.push_back({pass.name, pass.width, pass.height});
+            auto gpuIt = m_passGpuMs.find(pass.name);
+            if (gpuIt != m_passGpuMs.end()) {
+                leftoverMs -= gpuIt->second;
+            }
+        }
+        float duration = m_timeline->getDuration();
 
-                // Hysteresis-based render scaling
-                Settings& settings = Settings::getInstance();
-                const float MIN_SCALE = 0.01f;
-                const float MAX_SCALE = 1.0f;
-                const int FRAMES_TO_INCREASE_SCALE = 60; // Require 60 consecutive frames
-                const int FRAMES_TO_DECREASE_SCALE = 10; // Require 10 consecutive frames
-
-                if (m_fpsHistory.size() >= 10) { // Only adjust if we have enough data
-                    float sum = 0.0f;
-                    for (float fps : m_fpsHistory) {
-                        sum += fps;
-                    }
-                    float averageFPS = sum / m_fpsHistory.size();
-
-                    const float SCALE_DOWN_STEP = 0.10f;
-                    const float SCALE_UP_STEP = 0.05f;
-                    const float LOW_FPS_THRESHOLD = settings.getLowFPSThreshold();
-                    const float HIGH_FPS_THRESHOLD = settings.getHighFPSThreshold();
-
-                    if (averageFPS < LOW_FPS_THRESHOLD) {
-                        m_framesBelowLowThreshold++;
-                        m_framesAboveHighThreshold = 0; // Reset the other counter
-                    } else if (averageFPS > HIGH_FPS_THRESHOLD) {
-                        m_framesBelowLowThreshold = 0; // Reset the other counter
-                        m_framesAboveHighThreshold++;
-                    } else {
-                        // FPS is in the stable range, reset counters
-                        m_framesBelowLowThreshold = 0;
-                        m_framesAboveHighThreshold = 0;
-                    }
+        // A parameter sweep requested in the panel is rendered at the current time
+        UniformSweep sweep;
+        if (m_parameterPanel->takeSweepRequest(sweep)) {
+            sweep.time = time;
+        }
 
-                    if (m_framesBelowLowThreshold >= FRAMES_TO_DECREASE_SCALE) {
-                        m_renderScaleFactor -= SCALE_DOWN_STEP;
-                        m_framesBelowLowThreshold = 0; // Reset after scaling
-                    } else if (m_framesAboveHighThreshold >= FRAMES_TO_INCREASE_SCALE) {
-                        m_renderScaleFactor += SCALE_UP_STEP;
-                        m_framesAboveHighThreshold = 0; // Reset after scaling
-                    }
+        auto job = [this, passes, time, scaleMode, viewPass, view, sharedPass,
+                    cacheFrames, cachePass, cacheSlice, cacheQuality,
+                    thumbnails, thumbnailPasses, duration, frameBudgetMs, leftoverMs, sweep]() {
+            m_shaderManager->setPreviewView(viewPass, view.x, view.y, view.width, view.height);
+            bool drawn = renderPasses(passes, time, scaleMode);
+            if (drawn && cacheFrames) {
+                cacheRenderedFrame(cachePass, cacheSlice, cacheQuality);
+            }
+            if (thumbnails) {
+                m_thumbnails->render(thumbnailPasses, viewPass, duration, drawn ? leftoverMs : frameBudgetMs);
+            }
+            // After the passes, so the sweep reads inputs of the same time
+            if (!sweep.pass.empty() && m_shaderManager->renderUniformSweep(sweep)) {
+                glFlush();
+            }
+            // Into their own targets, the preview targets keep their size and fill progress
+            renderPendingExports();
+            // Only new frames are published, an idle preview publishes nothing
+            if (drawn && !sharedPass.empty()) {
+                GLuint textureId = m_shaderManager->getFramebufferTexture(sharedPass);
+                if (textureId != 0) {
+                    m_sharedReadback->request(textureId, sharedPass);
                 }
+            }
+            return drawn;
+        };
 
+        if (skipRender) {
+            LOG_DEBUG("Showing cached frame of {} at {}s", m_selectedShader, time);
+        } else if (m_renderThread) {
+            m_renderThread->submit(job, m_selectedShader);
+        } else {
+            job();
+        }
 
-                // Clamp the render scale factor
-                m_renderScaleFactor = std::clamp(m_renderScaleFactor, MIN_SCALE, MAX_SCALE);
-
-                // Log the render scale factor if it changes
-                static float lastLoggedScale = 1.0f;
-                if (std::abs(m_renderScaleFactor - lastLoggedScale) > 1e-4) {
-                    std::stringstream ss;
-                    ss << "Render scale factor changed to: " << std::fixed << std::setprecision(2) << m_renderScaleFactor;
-                    LOG_INFO(ss.str());
-                    lastLoggedScale = m_renderScaleFactor;
+        processPassTimings(passes, scaleMode);
 
-                    // Save local project state
-                    if (m_currentProject && m_currentProject->isLoaded()) {
-                        LocalProjectState localState;
-                        localState.renderScale = m_renderScaleFactor;
-                        m_currentProject->saveLocalState(localState);
-                    }
-                }
-                
-                // Add the FPS and the render scale factor that was used for THIS frame
-                m_timeline->addFPS(m_timeline->getCurrentTime(), currentFPS, lastRenderScaleFactor);
-            }
+        if (thumbnails) {
+            m_timeline->setThumbnails(m_thumbnails->getStrip(m_selectedShader));
+        } else {
+            m_timeline->setThumbnails(TimelineThumbnailStrip());
         }
     }
 
@@ -214,9 +254,23 @@ void ShaderEditor::render() {
     // Ensure ImGui doesn't capture navigation keys for internal use
     ImGuiIO& io = ImGui::GetIO();
     io.WantCaptureKeyboard = false; // Let our shortcuts always work
+
+    // Pending dumps may be rendered by the render thread, which needs the shader lock
+    if (m_exitRequested) {
+        shaderLock.unlock();
+        finishPendingWrites();
+        std::exit(0);  // Immediate exit to avoid cleanup hanging
+    }
 }
 
 ShaderEditor::~ShaderEditor() {
+    // The render thread executes jobs referring to this editor, stop it first
+    if (m_renderThread) {
+        m_renderThread->stop();
+    }
+    if (m_frameCacheTexture != 0) {
+        glDeleteTextures(1, &m_frameCacheTexture);
+    }
     // Components will be automatically destroyed
 }
 
@@ -255,15 +309,32 @@ bool ShaderEditor::initialize() {
     
     // Setup keyboard shortcuts
     setupShortcuts();
+
+    if (Settings::getInstance().getRenderThreadEnabled()) {
+        startRenderThread();
+    }
     
     return true;
 }
 
+void ShaderEditor::startRenderThread() {
+    if (m_renderThread) {
+        return;
+    }
+
+    // Render passes on a dedicated thread sharing objects with the UI context
+    m_renderThread = std::make_unique<RenderThread>(m_shaderManager);
+    if (!m_renderThread->start(glfwGetCurrentContext())) {
+        LOG_WARN("Falling back to rendering passes on the UI thread");
+        m_renderThread.reset();
+    }
+}
+
 void ShaderEditor::setupCallbacks() {
     // Menu system callbacks
     m_menuSystem->onExit = [this]() {
         LOG_INFO("File->Exit selected");
-        std::exit(0);  // Immediate exit to avoid cleanup hanging
+        m_exitRequested = true;
     };
     
     m_menuSystem->onShowHelp = [this]() {
@@ -305,6 +376,231 @@ void ShaderEditor::handleResize(int width, int height) {
     // Handle window resize if needed
 }
 
+std::vector<ShaderEditor::PassRenderInfo> ShaderEditor::collectPassRenderInfo(bool atOutputResolution) const {
+    bool previewSized = !atOutputResolution && Settings::getInstance().getRenderAtPreviewSize()
+                        && m_previewRenderSize.first > 0 && m_previewRenderSize.second > 0;
+
+    std::vector<PassRenderInfo> passes;
+    for (const auto& pass : m_currentProject->getPasses()) {
+        if (!pass.enabled) {
+            continue;
+        }
+        std::pair<int, int> size = resolvePassSize(pass, previewSized, 0);
+        float scale = atOutputResolution ? 1.0f : getPassScaleFactor(pass.name);
+        passes.push_back({pass.name, size.first, size.second, scale});
+    }
+    return passes;
+}
+
+std::pair<int, int> ShaderEditor::resolvePassSize(const ShaderPass& pass, bool previewSized, int depth) const {
+    // Limits chains of relative sizes (and breaks cycles)
+    const int maxDepth = 8;
+
+    std::pair<int, int> size = previewSized ? m_previewRenderSize : std::make_pair(m_screenWidth, m_screenHeight);
+    auto it = m_passOutputSizes.find(pass.name);
+    if (it != m_passOutputSizes.end()) {
+        size = it->second;
+
+        if (previewSized) {
+            // Passes with an explicit size keep their aspect and are only ever scaled down
+            float fit = std::min(static_cast<float>(m_previewRenderSize.first) / static_cast<float>(size.first),
+                                 static_cast<float>(m_previewRenderSize.second) / static_cast<float>(size.second));
+            if (fit < 1.0f) {
+                size.first = std::max(1, static_cast<int>(size.first * fit));
+                size.second = std::max(1, static_cast<int>(size.second * fit));
+            }
+        }
+    }
+
+    if (pass.scale > 0.0f) {
+        // Relative sizes follow the output (or the referenced pass) every frame
+        if (!pass.scaleRelativeTo.empty() && depth < maxDepth) {
+            for (const auto& source : m_currentProject->getPasses()) {
+                if (source.name == pass.scaleRelativeTo) {
+                    size = resolvePassSize(source, previewSized, depth + 1);
+                    break;
+                }
+            }
+        }
+        size.first = std::max(1, static_cast<int>(std::lround(size.first * pass.scale)));
+        size.second = std::max(1, static_cast<int>(std::lround(size.second * pass.scale)));
+    }
+    return size;
+}
+
+void ShaderEditor::updatePreviewRenderSize() {
+    // Number of frames the preview size must be stable before pass targets follow it
+    const int settleFrames = 10;
+    // Relative size change that is applied immediately (panel toggles, maximizing)
+    const float immediateChange = 0.25f;
+
+    std::pair<int, int> size = m_previewPanel->getPreviewPixelSize();
+    if (size.first <= 0 || size.second <= 0 || size == m_previewRenderSize) {
+        m_previewPendingSize = m_previewRenderSize;
+        m_previewSettleFrames = 0;
+        return;
+    }
+
+    if (size != m_previewPendingSize) {
+        m_previewPendingSize = size;
+        m_previewSettleFrames = 0;
+    } else {
+        m_previewSettleFrames++;
+    }
+
+    bool largeChange = m_previewRenderSize.first <= 0 || m_previewRenderSize.second <= 0
+        || std::abs(size.first - m_previewRenderSize.first) > m_previewRenderSize.first * immediateChange
+        || std::abs(size.second - m_previewRenderSize.second) > m_previewRenderSize.second * immediateChange;
+
+    if (largeChange || m_previewSettleFrames >= settleFrames) {
+        LOG_DEBUG("Preview render size changed to {}x{}", size.first, size.second);
+        m_previewRenderSize = size;
+        m_previewSettleFrames = 0;
+    }
+}
+
+RenderScaleMode ShaderEditor::getEffectiveRenderScaleMode() const {
+    RenderScaleMode settingMode = Settings::getInstance().getRenderScaleMode();
+    if (settingMode == RenderScaleMode::Auto) {
+        return m_timeline->isPlaying() ? RenderScaleMode::Resolution : RenderScaleMode::Chunk;
+    }
+    return settingMode;
+}
+
+bool ShaderEditor::renderPasses(const std::vector<PassRenderInfo>& passes, float time, RenderScaleMode scaleMode) {
+    // May run on the render thread: only touches the ShaderManager, whose mutex is held
+    bool drawn = false;
+    for (const auto& pass : passes) {
+        drawn |= m_shaderManager->renderToFramebuffer(pass.name, pass.width, pass.height, time, pass.scale, scaleMode);
+    }
+    return drawn;
+}
+
+void ShaderEditor::processPassTimings(const std::vector<PassRenderInfo>& passes, RenderScaleMode scaleMode) {
+    for (const auto& pass : passes) {
+        // GPU timings arrive a few frames after the pass was rendered. Each sample
+        // carries the timeline time and render scale of the frame it measured.
+        GpuTimer::Sample sample;
+        while (m_shaderManager->pollPassTiming(pass.name, sample)) {
+            float currentFPS = (sample.milliseconds > 1e-3f) ? (1000.0f / sample.milliseconds) : 0.0f;
+            m_passGpuMs[pass.name] = sample.milliseconds;
+
+            std::stringstream ss;
+            ss << "GPU Duration: " << std::fixed << std::setprecision(4) << sample.milliseconds << "ms, Current FPS: " << std::setprecision(2) << currentFPS;
+            LOG_DEBUG(ss.str());
+
+            if (scaleMode == RenderScaleMode::Tiled) {
+                // Tiled rendering is bounded by the tile budget, not by the render scale
+                continue;
+            }
+
+            float costPerMegapixel = m_scaleController->addSample(pass.name, sample.milliseconds, pass.width, pass.height, sample.pixelFraction);
+
+            // Add the FPS, the render scale factor and the cost of the measured frame
+            m_timeline->addFPS(sample.time, currentFPS, sample.renderScaleFactor, costPerMegapixel);
+        }
+    }
+}
+
+bool ShaderEditor::lookupCachedFrame(const FrameCache::Key& key) {
+    // The texture keeps the frame of the last lookup, staying on one slice costs nothing
+    if (key == m_frameCacheLookupKey) {
+        return m_frameCacheHit;
+    }
+    m_frameCacheLookupKey = key;
+
+    int width = 0;
+    int height = 0;
+    std::vector<unsigned char> pixels;
+    m_frameCacheHit = m_frameCache->lookup(key, width, height, pixels);
+    if (!m_frameCacheHit) {
+        return false;
+    }
+
+    if (m_frameCacheTexture == 0) {
+        glGenTextures(1, &m_frameCacheTexture);
+        glBindTexture(GL_TEXTURE_2D, m_frameCacheTexture);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+    }
+    glBindTexture(GL_TEXTURE_2D, m_frameCacheTexture);
+    glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA8, width, height, 0, GL_RGBA, GL_UNSIGNED_BYTE, pixels.data());
+    glBindTexture(GL_TEXTURE_2D, 0);
+    return true;
+}
+
+void ShaderEditor::cacheRenderedFrame(const PassRenderInfo& pass, int slice, float quality) {
+    // May run on the render thread, like renderPasses. Only complete images at full size
+    // are cached, not chunk fills in progress or reduced regions that were not upscaled.
+    if (m_shaderManager->getRenderProgress(pass.name) < 1.0f) {
+        return;
+    }
+    std::pair<float, float> uvScale = m_shaderManager->getFramebufferUVScale(pass.name);
+    if (uvScale.first < 1.0f || uvScale.second < 1.0f) {
+        return;
+    }
+
+    FrameCache::Key key{ pass.name, slice, m_shaderManager->computeFrameFingerprint(pass.name, pass.width, pass.height) };
+    if (!m_frameCache->wants(key, quality)) {
+        return;
+    }
+    GLuint textureId = m_shaderManager->getFramebufferTexture(pass.name);
+    if (textureId != 0) {
+        m_frameCacheReadback->request(textureId, "frame cache " + pass.name, m_frameCache->reserve(key, quality));
+    }
+}
+
+void ShaderEditor::updateRenderScale() {
+    Settings& settings = Settings::getInstance();
+    if (settings.getRenderScaleMode() == RenderScaleMode::Tiled) {
+        return;
+    }
+
+    if (!m_currentProject) {
+        return;
+    }
+
+    // The frame budget is divided between the enabled passes by their measured cost
+    std::vector<RenderScaleController::PassScale> passScales;
+    for (const auto& pass : m_currentProject->getPasses()) {
+        if (pass.enabled) {
+            passScales.push_back({pass.name, pass.pinScale, getPassScaleFactor(pass.name)});
+        }
+    }
+    m_scaleController->predictPassScales(*m_timeline, passScales, settings.getFrameBudgetMs());
+
+    if (!passScales.empty()) {
+        m_renderScaleFactor = 1.0f;
+        for (const auto& passScale : passScales) {
+            m_passScaleFactors[passScale.name] = passScale.scale;
+            m_renderScaleFactor = std::min(m_renderScaleFactor, passScale.scale);
+        }
+    }
+
+    // Log and persist the render scale factor once it has moved noticeably
+    static float lastLoggedScale = 1.0f;
+    if (std::abs(m_renderScaleFactor - lastLoggedScale) > 0.05f) {
+        std::stringstream ss;
+        ss << "Render scale factor changed to: " << std::fixed << std::setprecision(2) << m_renderScaleFactor;
+        LOG_INFO(ss.str());
+        lastLoggedScale = m_renderScaleFactor;
+
+        // Save local project state
+        if (m_currentProject && m_currentProject->isLoaded()) {
+            LocalProjectState localState;
+            localState.renderScale = m_renderScaleFactor;
+            m_currentProject->saveLocalState(localState);
+        }
+    }
+}
+
+float ShaderEditor::getPassScaleFactor(const std::string& passName) const {
+    auto it = m_passScaleFactors.find(passName);
+    return it != m_passScaleFactors.end() ? it->second : m_renderScaleFactor;
+}
+
 void ShaderEditor::renderMainLayout() {
     ImVec2 windowSize = ImGui::GetContentRegionAvail();
 
@@ -358,7 +654,29 @@ void ShaderEditor::renderMainLayout() {
     ImGui::BeginChild("PreviewPanel", rightContentSize, true, noNavFlags);
     GLuint finalTexture = m_shaderManager->getFramebufferTexture(m_selectedShader);
     std::pair<float, float> uvScale = m_shaderManager->getFramebufferUVScale(m_selectedShader);
-    m_previewPanel->render(finalTexture, m_timeline->getCurrentTime(), m_renderScaleFactor, uvScale);
+    if (m_renderThread) {
+        // Show the newest frame the render thread has completed
+        RenderThread::Frame frame = m_renderThread->acquireLatestFrame();
+        finalTexture = frame.textureId;
+        uvScale = frame.uvScale;
+    }
+    float renderProgress = m_shaderManager->getRenderProgress(m_selectedShader);
+    if (m_showingCachedFrame) {
+        finalTexture = m_frameCacheTexture;
+        uvScale = {1.0f, 1.0f};
+    }
+
+    FrameCache::Stats cacheStats = m_frameCache->getStats();
+    PreviewCacheStatus cacheStatus;
+    cacheStatus.enabled = cacheStats.budgetBytes > 0;
+    cacheStatus.showingCachedFrame = m_showingCachedFrame;
+    cacheStatus.frames = cacheStats.frames;
+    cacheStatus.memoryBytes = cacheStats.memoryBytes;
+    cacheStatus.budgetBytes = cacheStats.budgetBytes;
+    cacheStatus.hits = cacheStats.hits;
+    cacheStatus.misses = cacheStats.misses;
+    m_previewPanel->setCacheStatus(cacheStatus);
+    m_previewPanel->render(finalTexture, m_timeline->getCurrentTime(), getPassScaleFactor(m_selectedShader), uvScale, renderProgress);
     ImGui::EndChild();
     
     ImGui::EndChild(); // End RightSide
@@ -401,6 +719,9 @@ bool ShaderEditor::shouldExit() const {
 }
 
 bool ShaderEditor::handleKeyPress(int key, int scancode, int action, int mods) {
+    // Shortcuts may reload shaders or read framebuffers shared with the render thread
+    std::lock_guard<std::recursive_mutex> shaderLock(m_shaderManager->getMutex());
+
     // Handle shortcuts first
     return m_shortcutManager->handleKeyPress(nullptr, key, scancode, action, mods);
 }
@@ -481,7 +802,14 @@ void ShaderEditor::setupFileWatching() {
 bool ShaderEditor::loadProjectFromPath(const std::string& projectPath) {
     // Clear current shaders
     m_shaderManager->clearShaders();
+    m_frameCache->clear();
+    m_thumbnails->clear();
+    m_passGpuMs.clear();
+    m_frameCacheLookupKey = FrameCache::Key();
+    m_frameCacheHit = false;
     m_passOutputSizes.clear();
+    m_scaleController->reset();
+    m_passScaleFactors.clear();
     
     bool success = false;
     
@@ -651,30 +979,96 @@ void ShaderEditor::processPendingReloads() {
     }
 }
 
-#define STB_IMAGE_WRITE_IMPLEMENTATION
-#include "stb_image_write.h"
-
 void ShaderEditor::dumpFramebuffer(const std::string& passName, const std::string& outputPath) {
-    GLuint textureId = m_shaderManager->getFramebufferTexture(passName);
-    if (textureId == 0) {
+    if (!m_currentProject) {
         LOG_ERROR("Framebuffer for pass '{}' not found.", passName);
         return;
     }
 
-    int width, height;
-    glBindTexture(GL_TEXTURE_2D, textureId);
-    glGetTexLevelParameteriv(GL_TEXTURE_2D, 0, GL_TEXTURE_WIDTH, &width);
-    glGetTexLevelParameteriv(GL_TEXTURE_2D, 0, GL_TEXTURE_HEIGHT, &height);
+    std::lock_guard<std::recursive_mutex> lock(m_shaderManager->getMutex());
+    m_pendingExports.push_back({passName, outputPath, m_timeline->getCurrentTime(), collectPassRenderInfo(true)});
+}
+
+void ShaderEditor::renderPendingExports() {
+    if (m_pendingExports.empty()) {
+        return;
+    }
+
+    for (const auto& request : m_pendingExports) {
+        // Everything the dumped pass reads comes before it, at full scale in a single draw
+        for (const auto& pass : request.passes) {
+            m_shaderManager->renderPassExport(pass.name, pass.width, pass.height, request.time);
+            if (pass.name == request.pass) {
+                break;
+            }
+        }
+
+        GLuint textureId = m_shaderManager->getExportTexture(request.pass);
+        if (textureId == 0) {
+            LOG_ERROR("Framebuffer for pass '{}' not found.", request.pass);
+            continue;
+        }
+
+        // Read back asynchronously, the file is written a few frames later on the writer thread
+        m_frameReadback->request(textureId, request.path);
 
-    unsigned char* data = new unsigned char[width * height * 3];
-    glGetTexImage(GL_TEXTURE_2D, 0, GL_RGB, GL_UNSIGNED_BYTE, data);
+        LOG_IMPORTANT("Dumping framebuffer for pass '{}' to {}", request.pass, request.path);
+    }
+    m_pendingExports.clear();
+
+    // Output-sized targets are only needed until the copies are queued
+    m_shaderManager->releaseExportTargets();
+}
+
+void ShaderEditor::finishPendingWrites() {
+    // Dumps still queued are rendered now, by the render thread if it owns the passes.
+    // Must not be called with the shader lock held while the render thread is running.
+    bool pending;
+    {
+        std::lock_guard<std::recursive_mutex> lock(m_shaderManager->getMutex());
+        pending = !m_pendingExports.empty();
+    }
+    if (pending && m_renderThread && m_renderThread->isRunning()) {
+        m_renderThread->submit([this]() {
+            renderPendingExports();
+            return false;
+        }, m_selectedShader);
+        while (true) {
+            {
+                std::lock_guard<std::recursive_mutex> lock(m_shaderManager->getMutex());
+                if (m_pendingExports.empty()) {
+                    break;
+                }
+            }
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+    } else if (pending) {
+        std::lock_guard<std::recursive_mutex> lock(m_shaderManager->getMutex());
+        renderPendingExports();
+    }
 
-    stbi_flip_vertically_on_write(1);
-    stbi_write_png(outputPath.c_str(), width, height, 3, data, width * 3);
+    // Reads issued by the render thread can be finished here, the buffers are shared
+    m_frameReadback->flush();
+}
 
-    delete[] data;
+bool ShaderEditor::setSharedOutput(const std::string& passName, const std::string& name) {
+    auto output = std::make_unique<SharedFrameOutput>();
+    if (!output->open(name)) {
+        return false;
+    }
 
-    LOG_IMPORTANT("Framebuffer for pass '{}' dumped to {}", passName, outputPath);
+    // Frames are copied from the mapped pixel buffer straight into the ring. Read backs
+    // are timed on the steady clock, which is CLOCK_MONOTONIC, the clock consumers use.
+    SharedFrameOutput* target = output.get();
+    m_sharedReadback = std::make_unique<FrameReadback>([target](const FrameReadback::MappedFrame& frame) {
+        auto timestamp = std::chrono::duration_cast<std::chrono::nanoseconds>(frame.requested.time_since_epoch());
+        target->publish(frame.pixels, frame.width, frame.height, static_cast<uint64_t>(timestamp.count()));
+        return true;
+    });
+    m_sharedOutput = std::move(output);
+    m_sharedOutputPass = passName;
+    LOG_IMPORTANT("Publishing pass '{}' to shared memory {}", passName, m_sharedOutput->getName());
+    return true;
 }
 
 void ShaderEditor::takeScreenshot() {
@@ -700,6 +1094,7 @@ void ShaderEditor::takeScreenshot() {
     std::string filename = "" + ss.str() + ".png";
     std::filesystem::path outputPath = screenshotsPath / filename;
 
+    // Rendered at the output resolution by the next frame
     dumpFramebuffer(m_selectedShader, outputPath.string());
 }
 
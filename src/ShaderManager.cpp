@@ -2,7 +2,6 @@
 #include "ShaderPreprocessor.h"
 #include "Logger.h"
 #include "glad.h"
-#include "imgui/imgui.h"
 #include "Settings.h"
 #include "RenderScaleMode.h"
 #include <fstream>
@@ -12,6 +11,25 @@
 #include <regex> // Required for regex_search
 #include <filesystem> // Required for path manipulation
 #include <cmath>
+#include <algorithm>
+
+// Edge length of a tile in tiled rendering mode and of adaptive refresh
+static const int TILE_SIZE = 128;
+
+// Samples per axis taken from a tile when adaptive refresh measures its change
+static const int CHANGE_SAMPLES = 16;
+
+// Vertex shader shared by the internal full-screen programs
+static const char* QUAD_VERTEX_SOURCE = R"(
+    #version 330 core
+    layout (location = 0) in vec2 aPos;
+    layout (location = 1) in vec2 aTexCoord;
+    out vec2 TexCoord;
+    void main() {
+        gl_Position = vec4(aPos, 0.0, 1.0);
+        TexCoord = aTexCoord;
+    }
+)";
 
 // Helper function to read a file's content
 static std::string readFileContent(const std::string& filePath) {
@@ -24,7 +42,7 @@ static std::string readFileContent(const std::string& filePath) {
     return buffer.str();
 }
 
-ShaderManager::ShaderManager() : m_quadVAO(0), m_quadVBO(0), m_preprocessor(new ShaderPreprocessor()) {
+ShaderManager::ShaderManager() : m_quadVAO(0), m_quadVBO(0), m_viewQuadVAO(0), m_viewQuadVBO(0), m_preprocessor(new ShaderPreprocessor()) {
     // Full-screen quad vertices
     float vertices[] = {
         -1.0f, -1.0f, 0.0f, 0.0f,
@@ -36,25 +54,20 @@ ShaderManager::ShaderManager() : m_quadVAO(0), m_quadVBO(0), m_preprocessor(new
          1.0f,  1.0f, 1.0f, 1.0f
     };
     
-    glGenVertexArrays(1, &m_quadVAO);
     glGenBuffers(1, &m_quadVBO);
-    
-    glBindVertexArray(m_quadVAO);
     glBindBuffer(GL_ARRAY_BUFFER, m_quadVBO);
     glBufferData(GL_ARRAY_BUFFER, sizeof(vertices), vertices, GL_STATIC_DRAW);
-    
-    // Position attribute
-    glVertexAttribPointer(0, 2, GL_FLOAT, GL_FALSE, 4 * sizeof(float), (void*)0);
-    glEnableVertexAttribArray(0);
-    
-    // Texture coordinate attribute
-    glVertexAttribPointer(1, 2, GL_FLOAT, GL_FALSE, 4 * sizeof(float), (void*)(2 * sizeof(float)));
-    glEnableVertexAttribArray(1);
-    
+
+    glGenBuffers(1, &m_viewQuadVBO);
+    glBindBuffer(GL_ARRAY_BUFFER, m_viewQuadVBO);
+    glBufferData(GL_ARRAY_BUFFER, sizeof(vertices), vertices, GL_DYNAMIC_DRAW);
     glBindBuffer(GL_ARRAY_BUFFER, 0);
-    glBindVertexArray(0);
 
+    // The VAOs are created lazily by the context that renders the passes
     setupSimpleTextureProgram();
+    setupUpscaleProgram();
+    setupScatterProgram();
+    setupChangeProgram();
 }
 
 ShaderManager::~ShaderManager() {
@@ -65,8 +78,48 @@ ShaderManager::~ShaderManager() {
     if (m_simpleTextureProgram.programId != 0) {
         glDeleteProgram(m_simpleTextureProgram.programId);
     }
-    glDeleteVertexArrays(1, &m_quadVAO);
+    if (m_upscaleProgram.programId != 0) {
+        glDeleteProgram(m_upscaleProgram.programId);
+    }
+    if (m_scatterProgram.programId != 0) {
+        glDeleteProgram(m_scatterProgram.programId);
+    }
+    if (m_changeProgram.programId != 0) {
+        glDeleteProgram(m_changeProgram.programId);
+    }
+    if (m_quadVAO != 0) {
+        glDeleteVertexArrays(1, &m_quadVAO);
+    }
+    if (m_viewQuadVAO != 0) {
+        glDeleteVertexArrays(1, &m_viewQuadVAO);
+    }
     glDeleteBuffers(1, &m_quadVBO);
+    glDeleteBuffers(1, &m_viewQuadVBO);
+}
+
+GLuint ShaderManager::createQuadVAO(GLuint vbo) {
+    GLuint vao;
+    glGenVertexArrays(1, &vao);
+    glBindVertexArray(vao);
+    glBindBuffer(GL_ARRAY_BUFFER, vbo);
+    
+    // Position attribute
+    glVertexAttribPointer(0, 2, GL_FLOAT, GL_FALSE, 4 * sizeof(float), (void*)0);
+    glEnableVertexAttribArray(0);
+    
+    // Texture coordinate attribute
+    glVertexAttribPointer(1, 2, GL_FLOAT, GL_FALSE, 4 * sizeof(float), (void*)(2 * sizeof(float)));
+    glEnableVertexAttribArray(1);
+    
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+    glBindVertexArray(0);
+    return vao;
+}
+
+void ShaderManager::releaseRetiredResources() {
+    m_retiredFramebuffers.clear();
+    m_retiredTimers.clear();
+    m_retiredRefresh.clear();
 }
 
 
@@ -77,6 +130,7 @@ std::shared_ptr<ShaderManager::ShaderProgram> ShaderManager::loadShader(
     const std::string& fragmentPath,
     RenderScaleMode scaleMode) {
     
+    std::lock_guard<std::recursive_mutex> lock(m_mutex);
     LOG_DEBUG("[ShaderManager] Loading shader '{}': {} + {}", name, vertexPath, fragmentPath);
     
     m_errorLogged[name] = false;
@@ -85,8 +139,24 @@ std::shared_ptr<ShaderManager::ShaderProgram> ShaderManager::loadShader(
     shader->fragmentPath = fragmentPath;
     shader->isValid = false;
 
-    auto vertexResult = m_preprocessor->preprocess(vertexPath, scaleMode);
-    auto fragmentResult = m_preprocessor->preprocess(fragmentPath, scaleMode);
+    // Scatter chunk rendering draws every pixel of its low resolution target, so the
+    // shaders are built without the stipple discard
+    RenderScaleMode preprocessMode = scaleMode;
+    if ((scaleMode == RenderScaleMode::Chunk || scaleMode == RenderScaleMode::Auto)
+        && Settings::getInstance().getChunkMethod() == ChunkMethod::Scatter) {
+        preprocessMode = RenderScaleMode::Resolution;
+    }
+
+    auto vertexResult = m_preprocessor->preprocess(vertexPath, preprocessMode);
+    auto fragmentResult = m_preprocessor->preprocess(fragmentPath, preprocessMode);
+    shader->fragCoordMapped = fragmentResult.fragCoordMapped;
+    if (!shader->fragCoordMapped) {
+        // Zoom and scatter both move gl_FragCoord, without it the pass is drawn as is
+        LOG_WARN("Shader '{}' redeclares gl_FragCoord, preview zoom and scatter chunk rendering are disabled for it", name);
+        if (preprocessMode != scaleMode) {
+            fragmentResult = m_preprocessor->preprocess(fragmentPath, scaleMode);
+        }
+    }
 
     shader->preprocessedVertexSource = vertexResult.source;
     shader->preprocessedFragmentSource = fragmentResult.source;
@@ -203,7 +273,8 @@ std::shared_ptr<ShaderManager::ShaderProgram> ShaderManager::loadShader(
                 nameStr == "u_mouse_rel" || nameStr == "u_fork_cam_mouse" ||
                 nameStr == "iTime" || nameStr == "iResolution" || nameStr == "iMouse" ||
                 nameStr == "u_progressive_fill" || nameStr == "u_render_phase" ||
-                nameStr == "u_renderChunkFactor" || nameStr == "u_time_offset" || nameStr == "u_chunk_stride") {
+                nameStr == "u_renderChunkFactor" || nameStr == "u_time_offset" || nameStr == "u_chunk_stride" ||
+                nameStr == "u_view_scale" || nameStr == "u_view_offset") {
                 
                 if (nameStr == "u_mouse" || nameStr == "iMouse") {
                     shader->systemUniformTypes[nameStr] = type;
@@ -294,6 +365,10 @@ std::shared_ptr<ShaderManager::ShaderProgram> ShaderManager::loadShader(
     
     shader->isValid = true;
     m_shaders[name] = shader;
+    invalidateRenderProgress(name);
+
+    // Make the new program visible to a render thread context sharing objects with this one
+    glFlush();
     
     if (m_compilationCallback) {
         m_compilationCallback(name, true, "");
@@ -384,6 +459,23 @@ void ShaderManager::setMousePosition(float x, float y) {
     m_mouseUniform[1] = y;
 }
 
+void ShaderManager::setPreviewView(const std::string& passName, float x, float y, float width, float height) {
+    std::lock_guard<std::recursive_mutex> lock(m_mutex);
+    if (passName.empty() || (width >= 1.0f && height >= 1.0f)) {
+        m_viewPass.clear();
+        x = 0.0f;
+        y = 0.0f;
+        width = 1.0f;
+        height = 1.0f;
+    } else {
+        m_viewPass = passName;
+    }
+    m_viewRect[0] = x;
+    m_viewRect[1] = y;
+    m_viewRect[2] = std::max(1e-4f, width);
+    m_viewRect[3] = std::max(1e-4f, height);
+}
+
 void ShaderManager::setMouseClickState(bool clicked) {
     m_mouseUniform[2] = clicked ? 1.0f : 0.0f;
 }
@@ -632,12 +724,22 @@ std::string ShaderManager::remapErrorLog(const std::string& log, const std::vect
     return output.str();
 }
 
-void ShaderManager::renderToFramebuffer(const std::string& name, int width, int height, float time, float renderScaleFactor, RenderScaleMode scaleMode) {
+bool ShaderManager::renderToFramebuffer(const std::string& name, int width, int height, float time, float renderScaleFactor, RenderScaleMode scaleMode) {
+    std::lock_guard<std::recursive_mutex> lock(m_mutex);
+
+    if (m_quadVAO == 0) {
+        m_quadVAO = createQuadVAO(m_quadVBO);
+        m_viewQuadVAO = createQuadVAO(m_viewQuadVBO);
+    }
+    releaseRetiredResources();
+    collectPassTimings(name);
+
     int scaledWidth, scaledHeight;
     bool chunkMode = (scaleMode == RenderScaleMode::Chunk);
+    bool tiledMode = (scaleMode == RenderScaleMode::Tiled);
 
-    if (chunkMode) {
-        // In chunk mode, we maintain full resolution but render sparsely
+    if (chunkMode || tiledMode) {
+        // In chunk and tiled mode, we maintain full resolution but render sparsely
         scaledWidth = width;
         scaledHeight = height;
     } else {
@@ -651,18 +753,22 @@ void ShaderManager::renderToFramebuffer(const std::string& name, int width, int
     int targetAllocWidth = width;
     int targetAllocHeight = height;
 
+    std::vector<GLenum> formats = getPassFormats(name);
     auto it = m_framebuffers.find(name);
     if (it == m_framebuffers.end()) {
-        m_framebuffers[name] = std::make_unique<Framebuffer>(targetAllocWidth, targetAllocHeight);
-    } else if (it->second->getWidth() != targetAllocWidth || it->second->getHeight() != targetAllocHeight) {
-        // Only resize if the full resolution target changes
-        it->second->resize(targetAllocWidth, targetAllocHeight);
+        m_framebuffers[name] = std::make_unique<Framebuffer>(targetAllocWidth, targetAllocHeight, formats);
+    } else {
+        if (it->second->getWidth() != targetAllocWidth || it->second->getHeight() != targetAllocHeight) {
+            // Only resize if the full resolution target changes
+            it->second->resize(targetAllocWidth, targetAllocHeight);
+        }
+        it->second->setFormats(formats);
     }
     
     // UPSCALING LOGIC
     // If we are in Chunk mode, but the current buffer content is scaled down (from a previous Resolution render),
     // we need to upscale the content to fill the buffer before we start rendering sparse chunks.
-    if (chunkMode) {
+    if (chunkMode || tiledMode) {
         auto scaleIt = m_framebufferScales.find(name);
         if (scaleIt != m_framebufferScales.end()) {
             float sx = scaleIt->second.first;
@@ -672,6 +778,7 @@ void ShaderManager::renderToFramebuffer(const std::string& name, int width, int
                 performUpscale(name, targetAllocWidth, targetAllocHeight, sx, sy);
             }
         }
+        m_displayValid[name] = false;
     }
     
     // Calculate valid UV region for this frame
@@ -684,32 +791,219 @@ void ShaderManager::renderToFramebuffer(const std::string& name, int width, int
         m_framebufferScales[name] = {1.0f, 1.0f};
     }
 
+    // Progressive fill tracking: every phase of the stipple pattern has to be drawn once
+    // with unchanged inputs before the framebuffer is complete. Once complete, no more
+    // draws are issued until something changes.
+    int stride = std::max(1, static_cast<int>(1.0f / renderScaleFactor));
+
+    // Scatter chunk rendering draws the pixels of one phase (one pixel of every stride x stride
+    // cell) as a dense 1/stride sized image, which is then scattered into the framebuffer.
+    // Passes that redeclare gl_FragCoord are never zoomed or scattered (see loadShader).
+    auto shader = getShader(name);
+    bool fragCoordMapped = !shader || shader->fragCoordMapped;
+    bool zoomed = name == m_viewPass && fragCoordMapped;
+    bool scatterMode = chunkMode && stride > 1 && m_scatterProgram.programId != 0
+                       && Settings::getInstance().getChunkMethod() == ChunkMethod::Scatter
+                       && fragCoordMapped;
+
+    // Adaptive refresh schedules the tiles of tiled passes, and the stipple phases of each
+    // screen tile of chunk passes, by how much they change
+    bool adaptiveRefresh = (tiledMode || (chunkMode && !scatterMode)) && Settings::getInstance().getAdaptiveRefresh();
+    if (adaptiveRefresh) {
+        auto& refresh = m_adaptiveRefresh[name];
+        if (!refresh) {
+            refresh = std::make_unique<AdaptiveRefresh>();
+        }
+        refresh->resize(width, height, TILE_SIZE, formats[0], chunkMode ? stride : 1);
+        refresh->poll();
+    } else {
+        m_adaptiveRefresh.erase(name);
+    }
+
+    int phase = 0;
+    if (chunkMode && adaptiveRefresh) {
+        // Each tile phase keeps the time it was last drawn at, so time is not part of the inputs
+        auto& progress = m_chunkProgress[name];
+        size_t fingerprint = computeInputFingerprint(name, width, height, 0.0f, stride);
+        int totalPhases = stride * stride;
+        AdaptiveRefresh& refresh = *m_adaptiveRefresh[name];
+        if (fingerprint != progress.fingerprint || totalPhases != progress.totalPhases) {
+            refresh.invalidate();
+            progress.fingerprint = fingerprint;
+            progress.totalPhases = totalPhases;
+        } else if (refresh.getProgress(time) >= 1.0f) {
+            return false;
+        }
+    } else if (chunkMode) {
+        auto& progress = m_chunkProgress[name];
+        size_t fingerprint = computeInputFingerprint(name, width, height, time, stride);
+        int totalPhases = stride * stride;
+
+        if (fingerprint != progress.fingerprint || totalPhases != progress.totalPhases) {
+            // A finished fill restarts from phase 0. If inputs change mid-fill (e.g. while
+            // dragging a slider) the rotation continues so stale phases keep refreshing.
+            if (progress.phasesFilled >= progress.totalPhases || totalPhases != progress.totalPhases) {
+                progress.nextPhase = 0;
+            }
+            progress.fingerprint = fingerprint;
+            progress.totalPhases = totalPhases;
+            progress.phasesFilled = 0;
+        }
+
+        if (progress.phasesFilled >= progress.totalPhases) {
+            return false;
+        }
+
+        phase = progress.nextPhase;
+        progress.nextPhase = (progress.nextPhase + 1) % progress.totalPhases;
+        progress.phasesFilled++;
+    } else {
+        m_chunkProgress.erase(name);
+    }
+
+    // Tiled rendering spreads one frame over several UI frames. The time of the frame
+    // is captured at its first tile so that all tiles of a frame match; any other input
+    // change restarts the frame immediately.
+    // With adaptive refresh each tile keeps the time it was last drawn at instead, and the
+    // tiles that change the most are redrawn at the current time first.
+    if (tiledMode) {
+        auto& tiles = m_tileProgress[name];
+        size_t fingerprint = computeInputFingerprint(name, width, height, 0.0f, 1); // Time is tracked separately
+        int tileCount = ((width + TILE_SIZE - 1) / TILE_SIZE) * ((height + TILE_SIZE - 1) / TILE_SIZE);
+        bool inputsChanged = fingerprint != tiles.fingerprint || tileCount != tiles.tileCount;
+        tiles.fingerprint = fingerprint;
+        tiles.tileCount = tileCount;
+
+        if (adaptiveRefresh) {
+            auto& refresh = m_adaptiveRefresh[name];
+            if (inputsChanged) {
+                refresh->invalidate();
+            } else if (refresh->getProgress(time) >= 1.0f) {
+                return false;
+            }
+            tiles.frameTime = time;
+        } else if (inputsChanged) {
+            tiles.nextTile = 0;
+            tiles.frameTime = time;
+        } else if (tiles.nextTile >= tiles.tileCount) {
+            if (time == tiles.frameTime) {
+                return false;
+            }
+            tiles.nextTile = 0;
+            tiles.frameTime = time;
+        }
+        time = tiles.frameTime;
+    } else {
+        m_tileProgress.erase(name);
+    }
+
     // Set texture filtering
     // Always use LINEAR filtering for smoother results when scaling
     m_framebuffers[name]->setFilter(GL_LINEAR);
 
-    m_framebuffers[name]->bind();
-    glViewport(0, 0, scaledWidth, scaledHeight); // Set viewport to scaled dimensions (renders to bottom-left corner)
+    int phaseX = phase % stride;
+    int phaseY = phase / stride;
+    int drawWidth = scaledWidth;
+    int drawHeight = scaledHeight;
+    if (scatterMode) {
+        drawWidth = (width - phaseX + stride - 1) / stride;
+        drawHeight = (height - phaseY + stride - 1) / stride;
+        int allocWidth = (width + stride - 1) / stride;
+        int allocHeight = (height + stride - 1) / stride;
+
+        auto& scatter = m_scatterFramebuffers[name];
+        if (!scatter) {
+            scatter = std::make_unique<Framebuffer>(allocWidth, allocHeight, formats);
+        } else {
+            if (scatter->getWidth() != allocWidth || scatter->getHeight() != allocHeight) {
+                scatter->resize(allocWidth, allocHeight);
+            }
+            scatter->setFormats(formats);
+        }
+        scatter->bind();
+    } else {
+        m_framebuffers[name]->bind();
+    }
+    glViewport(0, 0, drawWidth, drawHeight); // Set viewport to scaled dimensions (renders to bottom-left corner)
     useShader(name);
     setUniform("u_time", time);
     setUniform("iTime", time);
-    float resolution[3] = {(float)scaledWidth, (float)scaledHeight, (float)scaledWidth / (float)scaledHeight};
+
+    // A zoomed pass covers a sub-rectangle of a larger virtual image at the same pixel density.
+    // Resolution uniforms describe the virtual image and gl_FragCoord is offset into it.
+    float virtualWidth = static_cast<float>(scaledWidth);
+    float virtualHeight = static_cast<float>(scaledHeight);
+    float viewScale[2] = {1.0f, 1.0f};
+    float viewOffset[2] = {0.0f, 0.0f};
+    float texRect[4] = {0.0f, 0.0f, 1.0f, 1.0f}; // Texture coordinates at the viewport edges
+    if (zoomed) {
+        virtualWidth /= m_viewRect[2];
+        virtualHeight /= m_viewRect[3];
+        viewOffset[0] = m_viewRect[0] * virtualWidth;
+        viewOffset[1] = m_viewRect[1] * virtualHeight;
+        texRect[0] = m_viewRect[0];
+        texRect[1] = m_viewRect[1];
+        texRect[2] = m_viewRect[0] + m_viewRect[2];
+        texRect[3] = m_viewRect[1] + m_viewRect[3];
+    }
+    if (scatterMode) {
+        // Pixel i of the scatter target is pixel i * stride + phase of the frame
+        viewScale[0] = static_cast<float>(stride);
+        viewScale[1] = static_cast<float>(stride);
+        float shiftX = phaseX + 0.5f - 0.5f * stride;
+        float shiftY = phaseY + 0.5f - 0.5f * stride;
+        viewOffset[0] += shiftX;
+        viewOffset[1] += shiftY;
+
+        float frameRect[4] = {
+            shiftX / width,
+            shiftY / height,
+            (drawWidth * stride + shiftX) / width,
+            (drawHeight * stride + shiftY) / height
+        };
+        float spanX = texRect[2] - texRect[0];
+        float spanY = texRect[3] - texRect[1];
+        texRect[2] = texRect[0] + frameRect[2] * spanX;
+        texRect[3] = texRect[1] + frameRect[3] * spanY;
+        texRect[0] = texRect[0] + frameRect[0] * spanX;
+        texRect[1] = texRect[1] + frameRect[1] * spanY;
+    }
+    setUniform("u_view_scale", viewScale, 2);
+    setUniform("u_view_offset", viewOffset, 2);
+
+    // TexCoord based shaders see the visible region through the texture coordinates
+    GLuint quadVAO = m_quadVAO;
+    if (zoomed || scatterMode) {
+        float x0 = texRect[0];
+        float y0 = texRect[1];
+        float x1 = texRect[2];
+        float y1 = texRect[3];
+        float vertices[] = {
+            -1.0f, -1.0f, x0, y0,
+             1.0f, -1.0f, x1, y0,
+            -1.0f,  1.0f, x0, y1,
+
+            -1.0f,  1.0f, x0, y1,
+             1.0f, -1.0f, x1, y0,
+             1.0f,  1.0f, x1, y1
+        };
+        glBindBuffer(GL_ARRAY_BUFFER, m_viewQuadVBO);
+        glBufferSubData(GL_ARRAY_BUFFER, 0, sizeof(vertices), vertices);
+        glBindBuffer(GL_ARRAY_BUFFER, 0);
+        quadVAO = m_viewQuadVAO;
+    }
+
+    float resolution[3] = {virtualWidth, virtualHeight, virtualWidth / virtualHeight};
     setUniform("u_resolution", resolution, 2);
     setUniform("iResolution", resolution, 3);
+    bindPassInputs(name);
     
     // Chunk Rendering Uniforms
     if (chunkMode) {
         setUniform("u_progressive_fill", true);
         
-        // Calculate stride based on render scale factor
         // Stride = 1 / scale. E.g. 0.5 scale -> stride 2. 0.1 scale -> stride 10.
-        int stride = std::max(1, static_cast<int>(1.0f / renderScaleFactor));
         setUniform("u_chunk_stride", stride);
-        
-        // Use ImGui frame count for phase synchronization
-        int totalPhases = stride * stride;
-        int frameCount = ImGui::GetFrameCount();
-        int phase = frameCount % totalPhases; 
         setUniform("u_render_phase", phase);
         
         // Optional: pass the chunk factor if we want to support variable sparsity later
@@ -720,6 +1014,353 @@ void ShaderManager::renderToFramebuffer(const std::string& name, int width, int
         setUniform("u_progressive_fill", false);
     }
 
+    applyPassUniforms(name, virtualWidth, virtualHeight);
+
+    std::vector<int> tileList;
+    std::vector<AdaptiveRefresh::Draw> phaseDraws;
+    if (tiledMode) {
+        tileList = selectTiles(name, time);
+    } else if (chunkMode && adaptiveRefresh) {
+        // The budget is what a phase over the whole frame costs, spread over tile phases
+        AdaptiveRefresh& refresh = *m_adaptiveRefresh[name];
+        int tileCount = ((width + TILE_SIZE - 1) / TILE_SIZE) * ((height + TILE_SIZE - 1) / TILE_SIZE);
+        phaseDraws = refresh.selectTiles(time, tileCount);
+        refresh.beginTiles(m_framebuffers[name]->getFramebufferId());
+        auto& progress = m_chunkProgress[name];
+        progress.phasesFilled = static_cast<int>(refresh.getProgress(time) * progress.totalPhases);
+    }
+
+    auto& timer = m_passTimers[name];
+    if (!timer) {
+        timer = std::make_unique<GpuTimer>();
+    }
+    bool timing = timer->begin();
+
+    glBindVertexArray(quadVAO);
+    int tilesDrawn = static_cast<int>(tileList.size());
+    if (tiledMode) {
+        drawTiles(tileList, width, height);
+    } else if (!phaseDraws.empty()) {
+        drawPhaseTiles(phaseDraws, width, height);
+    } else {
+        glDrawArrays(GL_TRIANGLES, 0, 6);
+    }
+    glBindVertexArray(0);
+
+    if (timing) {
+        float pixelFraction = static_cast<float>(scaledWidth * scaledHeight) / static_cast<float>(std::max(1, width * height));
+        if (chunkMode && !phaseDraws.empty()) {
+            float tilePixels = static_cast<float>(phaseDraws.size() * TILE_SIZE * TILE_SIZE) / static_cast<float>(stride * stride);
+            pixelFraction = std::min(1.0f, tilePixels / static_cast<float>(std::max(1, width * height)));
+        } else if (chunkMode) {
+            pixelFraction = 1.0f / static_cast<float>(stride * stride);
+        } else if (tiledMode) {
+            pixelFraction = std::min(1.0f, static_cast<float>(tilesDrawn * TILE_SIZE * TILE_SIZE) / static_cast<float>(std::max(1, width * height)));
+        }
+        timer->end(time, tiledMode ? 1.0f : renderScaleFactor, pixelFraction, tilesDrawn);
+    }
+
+    // Measured outside the timed region so the tile cost estimate only covers the pass
+    if (adaptiveRefresh) {
+        glBindVertexArray(quadVAO);
+        m_adaptiveRefresh[name]->measureTiles(m_framebuffers[name]->getTextureId(), m_changeProgram);
+        glBindVertexArray(0);
+    }
+
+    m_framebuffers[name]->unbind();
+
+    if (scatterMode) {
+        scatterPhase(name, width, height, stride, phaseX, phaseY);
+    }
+
+    // Resample the reduced region to full size once per frame, instead of leaving it to
+    // bilinear sampling wherever the pass is displayed. Passes read by other passes are
+    // always resampled so they can be sampled over the full texture.
+    bool reducedScale = !chunkMode && !tiledMode && (scaledWidth < width || scaledHeight < height);
+    if (reducedScale && scaledWidth > 0 && scaledHeight > 0
+        && (Settings::getInstance().getUpscaleFilter() == UpscaleFilter::Lanczos || isPassInput(name))) {
+        upscaleToDisplay(name, width, height, scaledWidth, scaledHeight);
+    } else {
+        m_displayValid[name] = false;
+    }
+
+    glViewport(0, 0, width, height); // Restore viewport to original dimensions
+    m_passGenerations[name]++;
+    return true;
+}
+
+bool ShaderManager::renderPassBatch(const std::string& name, int width, int height, const std::vector<float>& times) {
+    std::lock_guard<std::recursive_mutex> lock(m_mutex);
+
+    auto shader = getShader(name);
+    if (!shader || !shader->isValid || times.empty() || width <= 0 || height <= 0) {
+        return false;
+    }
+    if (m_quadVAO == 0) {
+        m_quadVAO = createQuadVAO(m_quadVBO);
+        m_viewQuadVAO = createQuadVAO(m_viewQuadVBO);
+    }
+    releaseRetiredResources();
+
+    std::vector<GLenum> formats = getPassFormats(name);
+    auto& targets = m_batchFramebuffers[name];
+    for (size_t i = 0; i < times.size(); i++) {
+        if (i == targets.size()) {
+            targets.push_back(std::make_unique<Framebuffer>(width, height, formats));
+            targets.back()->setFilter(GL_LINEAR);
+        } else {
+            if (targets[i]->getWidth() != width || targets[i]->getHeight() != height) {
+                targets[i]->resize(width, height);
+            }
+            targets[i]->setFormats(formats);
+        }
+    }
+
+    // Everything but the time and the inputs is the same for all samples, so the program
+    // is bound and set up once and each sample costs a single draw
+    useShader(name);
+    float viewScale[2] = {1.0f, 1.0f};
+    float viewOffset[2] = {0.0f, 0.0f};
+    setUniform("u_view_scale", viewScale, 2);
+    setUniform("u_view_offset", viewOffset, 2);
+    float resolution[3] = {static_cast<float>(width), static_cast<float>(height), static_cast<float>(width) / static_cast<float>(height)};
+    setUniform("u_resolution", resolution, 2);
+    setUniform("iResolution", resolution, 3);
+    setUniform("u_progressive_fill", false);
+    applyPassUniforms(name, static_cast<float>(width), static_cast<float>(height));
+
+    glBindVertexArray(m_quadVAO);
+    for (size_t i = 0; i < times.size(); i++) {
+        targets[i]->bind();
+        bindPassInputs(name, static_cast<int>(i));
+        setUniform("u_time", times[i]);
+        setUniform("iTime", times[i]);
+        glDrawArrays(GL_TRIANGLES, 0, 6);
+    }
+    glBindVertexArray(0);
+    targets[times.size() - 1]->unbind();
+    return true;
+}
+
+void ShaderManager::copyBatchOutput(const std::string& name, size_t sample, GLuint textureId, int x, int y) {
+    std::lock_guard<std::recursive_mutex> lock(m_mutex);
+    auto it = m_batchFramebuffers.find(name);
+    if (it == m_batchFramebuffers.end() || sample >= it->second.size()) {
+        return;
+    }
+
+    const Framebuffer& source = *it->second[sample];
+    glBindFramebuffer(GL_READ_FRAMEBUFFER, source.getFramebufferId());
+    glReadBuffer(GL_COLOR_ATTACHMENT0);
+    glBindTexture(GL_TEXTURE_2D, textureId);
+    glCopyTexSubImage2D(GL_TEXTURE_2D, 0, x, y, 0, 0, source.getWidth(), source.getHeight());
+    glBindTexture(GL_TEXTURE_2D, 0);
+    glBindFramebuffer(GL_READ_FRAMEBUFFER, 0);
+}
+
+bool ShaderManager::renderPassExport(const std::string& name, int width, int height, float time) {
+    std::lock_guard<std::recursive_mutex> lock(m_mutex);
+
+    auto shader = getShader(name);
+    if (!shader || !shader->isValid || width <= 0 || height <= 0) {
+        return false;
+    }
+    if (m_quadVAO == 0) {
+        m_quadVAO = createQuadVAO(m_quadVBO);
+        m_viewQuadVAO = createQuadVAO(m_viewQuadVBO);
+    }
+    releaseRetiredResources();
+
+    std::vector<GLenum> formats = getPassFormats(name);
+    auto& target = m_exportFramebuffers[name];
+    if (!target) {
+        target = std::make_unique<Framebuffer>(width, height, formats);
+        target->setFilter(GL_LINEAR);
+    } else {
+        if (target->getWidth() != width || target->getHeight() != height) {
+            target->resize(width, height);
+        }
+        target->setFormats(formats);
+    }
+
+    target->bind();
+    useShader(name);
+    float viewScale[2] = {1.0f, 1.0f};
+    float viewOffset[2] = {0.0f, 0.0f};
+    setUniform("u_view_scale", viewScale, 2);
+    setUniform("u_view_offset", viewOffset, 2);
+    float resolution[3] = {static_cast<float>(width), static_cast<float>(height), static_cast<float>(width) / static_cast<float>(height)};
+    setUniform("u_resolution", resolution, 2);
+    setUniform("iResolution", resolution, 3);
+    setUniform("u_progressive_fill", false);
+    setUniform("u_time", time);
+    setUniform("iTime", time);
+    applyPassUniforms(name, static_cast<float>(width), static_cast<float>(height));
+    bindPassInputs(name, -1, true);
+
+    glBindVertexArray(m_quadVAO);
+    glDrawArrays(GL_TRIANGLES, 0, 6);
+    glBindVertexArray(0);
+    target->unbind();
+    return true;
+}
+
+GLuint ShaderManager::getExportTexture(const std::string& name) const {
+    auto it = m_exportFramebuffers.find(name);
+    if (it == m_exportFramebuffers.end()) {
+        return 0;
+    }
+    return it->second->getTextureId();
+}
+
+void ShaderManager::releaseExportTargets() {
+    std::lock_guard<std::recursive_mutex> lock(m_mutex);
+    for (auto& [passName, framebuffer] : m_exportFramebuffers) {
+        m_retiredFramebuffers.push_back(std::move(framebuffer));
+    }
+    m_exportFramebuffers.clear();
+}
+
+float UniformSweep::getX(int cell) const {
+    if (y.uniform.empty()) {
+        int count = columns * rows;
+        return count > 1 ? x.min + (x.max - x.min) * static_cast<float>(cell) / static_cast<float>(count - 1) : x.min;
+    }
+    int column = cell % columns;
+    return columns > 1 ? x.min + (x.max - x.min) * static_cast<float>(column) / static_cast<float>(columns - 1) : x.min;
+}
+
+float UniformSweep::getY(int cell) const {
+    int row = cell / columns;
+    return rows > 1 ? y.min + (y.max - y.min) * static_cast<float>(row) / static_cast<float>(rows - 1) : y.min;
+}
+
+bool ShaderManager::renderUniformSweep(const UniformSweep& sweep) {
+    std::lock_guard<std::recursive_mutex> lock(m_mutex);
+
+    auto shader = getShader(sweep.pass);
+    if (!shader || !shader->isValid || sweep.x.uniform.empty() || sweep.columns < 1 || sweep.rows < 1
+        || sweep.cellWidth <= 0 || sweep.cellHeight <= 0) {
+        return false;
+    }
+    if (!shader->fragCoordMapped) {
+        // Cells are placed by offsetting gl_FragCoord
+        LOG_WARN("Can't sweep '{}', it redeclares gl_FragCoord", sweep.pass);
+        return false;
+    }
+    if (m_quadVAO == 0) {
+        m_quadVAO = createQuadVAO(m_quadVBO);
+        m_viewQuadVAO = createQuadVAO(m_viewQuadVBO);
+    }
+    releaseRetiredResources();
+
+    int width = sweep.columns * sweep.cellWidth;
+    int height = sweep.rows * sweep.cellHeight;
+    std::vector<GLenum> formats = getPassFormats(sweep.pass);
+    if (!m_sweepFramebuffer) {
+        m_sweepFramebuffer = std::make_unique<Framebuffer>(width, height, formats);
+        m_sweepFramebuffer->setFilter(GL_LINEAR);
+    } else {
+        if (m_sweepFramebuffer->getWidth() != width || m_sweepFramebuffer->getHeight() != height) {
+            m_sweepFramebuffer->resize(width, height);
+        }
+        m_sweepFramebuffer->setFormats(formats);
+    }
+
+    // The swept uniforms start from their current values, only the swept component changes
+    struct SweptUniform {
+        GLint location = -1;
+        GLenum type = GL_FLOAT;
+        float value[4] = {0.0f, 0.0f, 0.0f, 0.0f};
+    };
+    auto findUniform = [&shader](const UniformSweep::Axis& axis) {
+        SweptUniform swept;
+        for (const auto& uniform : shader->uniforms) {
+            if (!axis.uniform.empty() && uniform.name == axis.uniform) {
+                swept.location = glGetUniformLocation(shader->programId, uniform.name.c_str());
+                swept.type = uniform.type;
+                std::copy(uniform.value, uniform.value + 4, swept.value);
+            }
+        }
+        return swept;
+    };
+    auto setSwept = [](const SweptUniform& swept) {
+        switch (swept.type) {
+            case GL_FLOAT: glUniform1f(swept.location, swept.value[0]); break;
+            case GL_FLOAT_VEC2: glUniform2fv(swept.location, 1, swept.value); break;
+            case GL_FLOAT_VEC3: glUniform3fv(swept.location, 1, swept.value); break;
+            case GL_FLOAT_VEC4: glUniform4fv(swept.location, 1, swept.value); break;
+        }
+    };
+    SweptUniform sweptX = findUniform(sweep.x);
+    SweptUniform sweptY = findUniform(sweep.y);
+    int componentX = std::clamp(sweep.x.component, 0, 3);
+    int componentY = std::clamp(sweep.y.component, 0, 3);
+    bool sameUniform = sweep.y.uniform == sweep.x.uniform;
+
+    // Each cell is a complete image of cellWidth x cellHeight. gl_FragCoord is moved back
+    // to the cell origin, texture coordinates span the cell's viewport anyway.
+    m_sweepFramebuffer->bind();
+    useShader(sweep.pass);
+    setUniform("u_time", sweep.time);
+    setUniform("iTime", sweep.time);
+    float viewScale[2] = {1.0f, 1.0f};
+    setUniform("u_view_scale", viewScale, 2);
+    float resolution[3] = {
+        static_cast<float>(sweep.cellWidth),
+        static_cast<float>(sweep.cellHeight),
+        static_cast<float>(sweep.cellWidth) / static_cast<float>(sweep.cellHeight)
+    };
+    setUniform("u_resolution", resolution, 2);
+    setUniform("iResolution", resolution, 3);
+    setUniform("u_progressive_fill", false);
+    bindPassInputs(sweep.pass);
+    applyPassUniforms(sweep.pass, resolution[0], resolution[1]);
+
+    glEnable(GL_SCISSOR_TEST);
+    glBindVertexArray(m_quadVAO);
+    for (int cell = 0; cell < sweep.columns * sweep.rows; cell++) {
+        // Cells are counted from the top, framebuffer rows from the bottom
+        int x = (cell % sweep.columns) * sweep.cellWidth;
+        int y = (sweep.rows - 1 - cell / sweep.columns) * sweep.cellHeight;
+        glViewport(x, y, sweep.cellWidth, sweep.cellHeight);
+        glScissor(x, y, sweep.cellWidth, sweep.cellHeight);
+        float viewOffset[2] = {-static_cast<float>(x), -static_cast<float>(y)};
+        setUniform("u_view_offset", viewOffset, 2);
+
+        // Two components of one uniform are set together
+        if (sweptY.location != -1 && !sameUniform) {
+            sweptY.value[componentY] = sweep.getY(cell);
+            setSwept(sweptY);
+        }
+        if (sweptX.location != -1) {
+            if (sweptY.location != -1 && sameUniform) {
+                sweptX.value[componentY] = sweep.getY(cell);
+            }
+            sweptX.value[componentX] = sweep.getX(cell);
+            setSwept(sweptX);
+        }
+        glDrawArrays(GL_TRIANGLES, 0, 6);
+    }
+    glBindVertexArray(0);
+    glDisable(GL_SCISSOR_TEST);
+    m_sweepFramebuffer->unbind();
+
+    m_sweep = sweep;
+    LOG_DEBUG("Rendered {}x{} sweep of {} over {}", sweep.columns, sweep.rows, sweep.pass, sweep.x.uniform);
+    return true;
+}
+
+GLuint ShaderManager::getUniformSweepTexture(UniformSweep& outSweep) const {
+    if (!m_sweepFramebuffer) {
+        return 0;
+    }
+    outSweep = m_sweep;
+    return m_sweepFramebuffer->getTextureId();
+}
+
+// Project uniforms and the mouse of a pass, whose image is virtualWidth x virtualHeight
+void ShaderManager::applyPassUniforms(const std::string& name, float virtualWidth, float virtualHeight) {
     auto shader = getShader(name);
     if (shader) {
         for (const auto& uniform : shader->uniforms) {
@@ -747,8 +1388,8 @@ void ShaderManager::renderToFramebuffer(const std::string& name, int width, int
     
     // iMouse: Shadertoy expects pixel coordinates (0 at bottom)
     float iMouse[4] = {0, 0, 0, 0};
-    iMouse[0] = m_mouseUniform[0] * width;
-    iMouse[1] = m_mouseUniform[1] * height;
+    iMouse[0] = m_mouseUniform[0] * virtualWidth;
+    iMouse[1] = m_mouseUniform[1] * virtualHeight;
     
     if (m_mouseUniform[2] > 0.5f) {
         iMouse[2] = iMouse[0];
@@ -782,24 +1423,422 @@ void ShaderManager::renderToFramebuffer(const std::string& name, int width, int
     setMouseUniform("u_mouse", u_mouse);
     setUniform("u_mouse_rel", m_mouseIntegrated, 2);
     setUniform("u_fork_cam_mouse", m_mouseIntegrated, 2);
+}
 
-    glBindVertexArray(m_quadVAO);
-    glDrawArrays(GL_TRIANGLES, 0, 6);
-    glBindVertexArray(0);
+std::vector<int> ShaderManager::selectTiles(const std::string& name, float time) {
+    auto& tiles = m_tileProgress[name];
+    float budgetMs = Settings::getInstance().getTileBudgetMs();
 
-    m_framebuffers[name]->unbind();
-    glViewport(0, 0, width, height); // Restore viewport to original dimensions
+    // Always draw at least one tile so that progress is guaranteed. Until the first GPU
+    // timing of this pass has arrived the tile cost is unknown, so only one tile is drawn.
+    int tilesToDraw = 1;
+    if (tiles.avgTileMs > 0.0f) {
+        tilesToDraw = std::max(1, static_cast<int>(budgetMs / tiles.avgTileMs));
+    }
+
+    std::vector<int> tileList;
+    auto refreshIt = m_adaptiveRefresh.find(name);
+    if (refreshIt != m_adaptiveRefresh.end()) {
+        AdaptiveRefresh& refresh = *refreshIt->second;
+        for (const auto& draw : refresh.selectTiles(time, tilesToDraw)) {
+            tileList.push_back(draw.tile);
+        }
+        // Keep the previous content of the tiles so their change can be measured
+        refresh.beginTiles(m_framebuffers[name]->getFramebufferId());
+        tiles.nextTile = static_cast<int>(refresh.getProgress(time) * tiles.tileCount + 0.5f);
+    } else {
+        tilesToDraw = std::min(tilesToDraw, tiles.tileCount - tiles.nextTile);
+        for (int i = 0; i < tilesToDraw; i++) {
+            tileList.push_back(tiles.nextTile++);
+        }
+    }
+    return tileList;
 }
 
-GLuint ShaderManager::getFramebufferTexture(const std::string& name) {
+void ShaderManager::drawTiles(const std::vector<int>& tileList, int width, int height) {
+    int columns = (width + TILE_SIZE - 1) / TILE_SIZE;
+
+    glEnable(GL_SCISSOR_TEST);
+    for (int tile : tileList) {
+        int tileX = (tile % columns) * TILE_SIZE;
+        int tileY = (tile / columns) * TILE_SIZE;
+        glScissor(tileX, tileY, std::min(TILE_SIZE, width - tileX), std::min(TILE_SIZE, height - tileY));
+        glDrawArrays(GL_TRIANGLES, 0, 6);
+    }
+    glDisable(GL_SCISSOR_TEST);
+}
+
+void ShaderManager::drawPhaseTiles(std::vector<AdaptiveRefresh::Draw> draws, int width, int height) {
+    // Tile phases are grouped by phase, the stipple discard keeps the phase's pixels of a tile
+    std::stable_sort(draws.begin(), draws.end(), [](const AdaptiveRefresh::Draw& a, const AdaptiveRefresh::Draw& b) {
+        return a.phase < b.phase;
+    });
+    int columns = (width + TILE_SIZE - 1) / TILE_SIZE;
+    int phase = -1;
+
+    glEnable(GL_SCISSOR_TEST);
+    for (const auto& draw : draws) {
+        if (draw.phase != phase) {
+            phase = draw.phase;
+            setUniform("u_render_phase", phase);
+        }
+        int tileX = (draw.tile % columns) * TILE_SIZE;
+        int tileY = (draw.tile / columns) * TILE_SIZE;
+        glScissor(tileX, tileY, std::min(TILE_SIZE, width - tileX), std::min(TILE_SIZE, height - tileY));
+        glDrawArrays(GL_TRIANGLES, 0, 6);
+    }
+    glDisable(GL_SCISSOR_TEST);
+}
+
+void ShaderManager::collectPassTimings(const std::string& name) {
+    auto timerIt = m_passTimers.find(name);
+    if (timerIt == m_passTimers.end()) {
+        return;
+    }
+
+    auto& timings = m_passTimings[name];
+    GpuTimer::Sample sample;
+    while (timerIt->second->poll(sample)) {
+        // Feed the tile cost estimate of tiled rendering
+        if (sample.tileCount > 0) {
+            auto tileIt = m_tileProgress.find(name);
+            if (tileIt != m_tileProgress.end()) {
+                float tileMs = sample.milliseconds / static_cast<float>(sample.tileCount);
+                float& avg = tileIt->second.avgTileMs;
+                avg = (avg <= 0.0f) ? tileMs : avg * 0.7f + tileMs * 0.3f;
+            }
+        }
+
+        timings.push_back(sample);
+        if (timings.size() > 16) {
+            timings.pop_front();
+        }
+    }
+}
+
+bool ShaderManager::pollPassTiming(const std::string& name, GpuTimer::Sample& outSample) {
+    auto it = m_passTimings.find(name);
+    if (it == m_passTimings.end() || it->second.empty()) {
+        return false;
+    }
+    outSample = it->second.front();
+    it->second.pop_front();
+    return true;
+}
+
+float ShaderManager::getRenderProgress(const std::string& name) const {
+    auto tileIt = m_tileProgress.find(name);
+    if (tileIt != m_tileProgress.end() && tileIt->second.tileCount > 0) {
+        return std::min(1.0f, static_cast<float>(tileIt->second.nextTile) / static_cast<float>(tileIt->second.tileCount));
+    }
+
+    auto it = m_chunkProgress.find(name);
+    if (it == m_chunkProgress.end() || it->second.totalPhases <= 0) {
+        return 1.0f;
+    }
+    return std::min(1.0f, static_cast<float>(it->second.phasesFilled) / static_cast<float>(it->second.totalPhases));
+}
+
+void ShaderManager::invalidateRenderProgress(const std::string& name) {
+    auto it = m_chunkProgress.find(name);
+    if (it != m_chunkProgress.end()) {
+        it->second.fingerprint = 0;
+    }
+    auto tileIt = m_tileProgress.find(name);
+    if (tileIt != m_tileProgress.end()) {
+        tileIt->second.fingerprint = 0;
+    }
+}
+
+void ShaderManager::setPassInputs(const std::string& name, const std::vector<ShaderPassInput>& inputs) {
+    std::lock_guard<std::recursive_mutex> lock(m_mutex);
+    std::vector<ShaderPassInput>& passInputs = m_passInputs[name];
+    passInputs.clear();
+    for (auto it = m_missingInputLogged.begin(); it != m_missingInputLogged.end();) {
+        it = it->first.compare(0, name.size() + 1, name + "/") == 0 ? m_missingInputLogged.erase(it) : std::next(it);
+    }
+    for (const auto& input : inputs) {
+        if (input.pass == name) {
+            // Reading the texture that is being rendered to is undefined
+            LOG_WARN("Pass '{}' lists itself as an input, ignoring it", name);
+            continue;
+        }
+        passInputs.push_back(input);
+    }
+}
+
+void ShaderManager::setPassOutputs(const std::string& name, const std::vector<ShaderPassOutput>& outputs) {
+    static const std::unordered_map<std::string, GLenum> formatNames = {
+        {"rgb8", GL_RGB8}, {"rgba8", GL_RGBA8}, {"r8", GL_R8},
+        {"r16f", GL_R16F}, {"r32f", GL_R32F}, {"rg16f", GL_RG16F}, {"rg32f", GL_RG32F},
+        {"rgba16f", GL_RGBA16F}, {"rgba32f", GL_RGBA32F}
+    };
+
+    std::lock_guard<std::recursive_mutex> lock(m_mutex);
+    if (outputs.empty()) {
+        m_passOutputs.erase(name);
+        return;
+    }
+
+    PassOutputs& passOutputs = m_passOutputs[name];
+    passOutputs.names.clear();
+    passOutputs.formats.clear();
+    for (const auto& output : outputs) {
+        auto formatIt = formatNames.find(output.format);
+        if (formatIt == formatNames.end()) {
+            LOG_WARN("Unknown format '{}' for output '{}' of pass '{}', using rgb8", output.format, output.name, name);
+        }
+        passOutputs.names.push_back(output.name);
+        passOutputs.formats.push_back(formatIt != formatNames.end() ? formatIt->second : GL_RGB8);
+    }
+}
+
+std::vector<GLenum> ShaderManager::getPassFormats(const std::string& name) const {
+    auto it = m_passOutputs.find(name);
+    if (it == m_passOutputs.end()) {
+        return {GL_RGB8};
+    }
+    return it->second.formats;
+}
+
+bool ShaderManager::isPassInput(const std::string& name) const {
+    for (const auto& [passName, inputs] : m_passInputs) {
+        for (const auto& input : inputs) {
+            if (input.pass == name) {
+                return true;
+            }
+        }
+    }
+    return false;
+}
+
+void ShaderManager::bindPassInputs(const std::string& name, int batchSample, bool exportInputs) {
+    auto it = m_passInputs.find(name);
+    if (it == m_passInputs.end()) {
+        return;
+    }
+
+    // Inputs are sampled over their whole texture, whatever size they were rendered at.
+    // A batch sample reads the inputs rendered for the same sample (renderPassBatch), an
+    // export the inputs exported along with it (renderPassExport).
+    const auto& inputs = it->second;
+    for (size_t i = 0; i < inputs.size(); i++) {
+        Framebuffer* source = nullptr;
+        bool ownTarget = batchSample >= 0 || exportInputs;
+        if (exportInputs) {
+            auto exportIt = m_exportFramebuffers.find(inputs[i].pass);
+            if (exportIt != m_exportFramebuffers.end()) {
+                source = exportIt->second.get();
+            }
+        } else if (batchSample >= 0) {
+            auto batchIt = m_batchFramebuffers.find(inputs[i].pass);
+            if (batchIt != m_batchFramebuffers.end() && batchSample < static_cast<int>(batchIt->second.size())) {
+                source = batchIt->second[batchSample].get();
+            }
+        } else {
+            auto inputIt = m_framebuffers.find(inputs[i].pass);
+            if (inputIt != m_framebuffers.end()) {
+                source = inputIt->second.get();
+            }
+        }
+        std::string index = std::to_string(i);
+        if (!source) {
+            // Never leave the sampler on whatever the unit held before
+            bool& logged = m_missingInputLogged[name + "/" + inputs[i].pass];
+            if (!logged) {
+                LOG_WARN("Input '{}' of pass '{}' has not been rendered, iChannel{} reads nothing", inputs[i].pass, name, index);
+                logged = true;
+            }
+            glActiveTexture(GL_TEXTURE0 + static_cast<GLenum>(i));
+            glBindTexture(GL_TEXTURE_2D, 0);
+            float noResolution[3] = {0.0f, 0.0f, 1.0f};
+            setUniform("iChannel" + index, static_cast<int>(i));
+            setUniform("iChannelResolution[" + index + "]", noResolution, 3);
+            continue;
+        }
+        float inputResolution[3] = {
+            static_cast<float>(source->getWidth()),
+            static_cast<float>(source->getHeight()),
+            1.0f
+        };
+
+        int attachment = 0;
+        if (!inputs[i].output.empty()) {
+            auto outputsIt = m_passOutputs.find(inputs[i].pass);
+            if (outputsIt != m_passOutputs.end()) {
+                const auto& names = outputsIt->second.names;
+                auto nameIt = std::find(names.begin(), names.end(), inputs[i].output);
+                if (nameIt != names.end()) {
+                    attachment = static_cast<int>(nameIt - names.begin());
+                }
+            }
+        }
+
+        GLuint textureId = ownTarget ? source->getTextureId(attachment) : getFramebufferTexture(inputs[i].pass, attachment);
+        glActiveTexture(GL_TEXTURE0 + static_cast<GLenum>(i));
+        glBindTexture(GL_TEXTURE_2D, textureId);
+        if (inputs[i].mipmap) {
+            if (ownTarget) {
+                // Batch and export targets are redrawn for every batch or export
+                glGenerateMipmap(GL_TEXTURE_2D);
+                glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
+            } else {
+                updateInputMipmaps(inputs[i], textureId);
+            }
+        }
+        setUniform("iChannel" + index, static_cast<int>(i));
+        setUniform("iChannelResolution[" + index + "]", inputResolution, 3);
+    }
+    glActiveTexture(GL_TEXTURE0);
+}
+
+void ShaderManager::updateInputMipmaps(const ShaderPassInput& input, GLuint textureId) {
+    // Every output format is filterable, so the driver's mipmap generation can be used. The
+    // chain is only rebuilt after the input drew again (or its texture was reallocated).
+    auto& mipmaps = m_inputMipmaps[input.pass + "." + input.output];
+    unsigned int generation = m_passGenerations[input.pass];
+    if (mipmaps.textureId == textureId && mipmaps.generation == generation) {
+        return;
+    }
+
+    glGenerateMipmap(GL_TEXTURE_2D);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
+    mipmaps.textureId = textureId;
+    mipmaps.generation = generation;
+}
+
+size_t ShaderManager::computeInputFingerprint(const std::string& name, int width, int height, float time, int stride) {
+    size_t hash = 0;
+    auto combine = [&hash](size_t value) {
+        hash ^= value + 0x9e3779b97f4a7c15ULL + (hash << 6) + (hash >> 2);
+    };
+    std::hash<float> hashFloat;
+
+    combine(std::hash<int>()(width));
+    combine(std::hash<int>()(height));
+    combine(std::hash<int>()(stride));
+    combine(hashFloat(time));
+
+    auto shader = getShader(name);
+    if (shader) {
+        combine(std::hash<GLuint>()(shader->programId));
+        for (const auto& uniform : shader->uniforms) {
+            for (int i = 0; i < 4; i++) {
+                combine(hashFloat(uniform.value[i]));
+            }
+        }
+    }
+
+    for (int i = 0; i < 3; i++) {
+        combine(hashFloat(m_mouseUniform[i]));
+    }
+    combine(hashFloat(m_mouseIntegrated[0]));
+    combine(hashFloat(m_mouseIntegrated[1]));
+
+    if (name == m_viewPass) {
+        for (int i = 0; i < 4; i++) {
+            combine(hashFloat(m_viewRect[i]));
+        }
+    }
+
+    auto inputIt = m_passInputs.find(name);
+    if (inputIt != m_passInputs.end()) {
+        for (const auto& input : inputIt->second) {
+            combine(std::hash<unsigned int>()(m_passGenerations[input.pass]));
+        }
+    }
+
+    // Never return the "unset" value so a fresh state always triggers a fill
+    return hash == 0 ? 1 : hash;
+}
+
+size_t ShaderManager::computeFrameFingerprint(const std::string& name, int width, int height) {
+    std::lock_guard<std::recursive_mutex> lock(m_mutex);
+    return computeFrameFingerprint(name, width, height, 0, true);
+}
+
+size_t ShaderManager::computeSourceFingerprint(const std::string& name) {
+    std::lock_guard<std::recursive_mutex> lock(m_mutex);
+    return computeFrameFingerprint(name, 0, 0, 0, false);
+}
+
+size_t ShaderManager::computeFrameFingerprint(const std::string& name, int width, int height, int depth, bool sized) {
+    // Limits chains of inputs (and breaks cycles)
+    const int maxDepth = 8;
+
+    size_t hash = 0;
+    auto combine = [&hash](size_t value) {
+        hash ^= value + 0x9e3779b97f4a7c15ULL + (hash << 6) + (hash >> 2);
+    };
+    std::hash<float> hashFloat;
+    std::hash<std::string> hashString;
+
+    combine(hashString(name));
+    if (sized) {
+        combine(std::hash<int>()(width));
+        combine(std::hash<int>()(height));
+    }
+
+    auto shader = getShader(name);
+    if (shader) {
+        combine(hashString(shader->preprocessedVertexSource));
+        combine(hashString(shader->preprocessedFragmentSource));
+        for (const auto& uniform : shader->uniforms) {
+            for (int i = 0; i < 4; i++) {
+                combine(hashFloat(uniform.value[i]));
+            }
+        }
+    }
+
+    for (int i = 0; i < 3; i++) {
+        combine(hashFloat(m_mouseUniform[i]));
+    }
+    combine(hashFloat(m_mouseIntegrated[0]));
+    combine(hashFloat(m_mouseIntegrated[1]));
+
+    if (sized && name == m_viewPass) {
+        for (int i = 0; i < 4; i++) {
+            combine(hashFloat(m_viewRect[i]));
+        }
+    }
+
+    auto inputIt = m_passInputs.find(name);
+    if (inputIt != m_passInputs.end() && depth < maxDepth) {
+        for (const auto& input : inputIt->second) {
+            std::pair<int, int> size = getFramebufferSize(input.pass);
+            combine(hashString(input.output));
+            combine(computeFrameFingerprint(input.pass, size.first, size.second, depth + 1, sized));
+        }
+    }
+    return hash;
+}
+
+GLuint ShaderManager::getFramebufferTexture(const std::string& name, int attachment) {
+    auto displayIt = m_displayFramebuffers.find(name);
+    if (displayIt != m_displayFramebuffers.end() && m_displayValid[name]) {
+        return displayIt->second->getTextureId(attachment);
+    }
+
     auto it = m_framebuffers.find(name);
     if (it != m_framebuffers.end()) {
-        return it->second->getTextureId();
+        return it->second->getTextureId(attachment);
     }
     return 0;
 }
 
+std::pair<int, int> ShaderManager::getFramebufferSize(const std::string& name) {
+    auto it = m_framebuffers.find(name);
+    if (it != m_framebuffers.end()) {
+        return {it->second->getWidth(), it->second->getHeight()};
+    }
+    return {0, 0};
+}
+
 std::pair<float, float> ShaderManager::getFramebufferUVScale(const std::string& name) {
+    if (m_displayValid[name]) {
+        return {1.0f, 1.0f};
+    }
+
     auto it = m_framebufferScales.find(name);
     if (it != m_framebufferScales.end()) {
         return it->second;
@@ -808,6 +1847,8 @@ std::pair<float, float> ShaderManager::getFramebufferUVScale(const std::string&
 }
 
 void ShaderManager::clearShaders() {
+    std::lock_guard<std::recursive_mutex> lock(m_mutex);
+
     // Clean up all shader programs
     for (auto& [name, shader] : m_shaders) {
         if (shader) {
@@ -818,7 +1859,46 @@ void ShaderManager::clearShaders() {
     // Clear the map
     m_shaders.clear();
     m_currentShader.clear();
+    for (auto& [passName, framebuffer] : m_framebuffers) {
+        m_retiredFramebuffers.push_back(std::move(framebuffer));
+    }
     m_framebuffers.clear();
+    for (auto& [passName, framebuffer] : m_scatterFramebuffers) {
+        m_retiredFramebuffers.push_back(std::move(framebuffer));
+    }
+    m_scatterFramebuffers.clear();
+    for (auto& [passName, framebuffer] : m_displayFramebuffers) {
+        m_retiredFramebuffers.push_back(std::move(framebuffer));
+    }
+    m_displayFramebuffers.clear();
+    m_displayValid.clear();
+    for (auto& [passName, targets] : m_batchFramebuffers) {
+        for (auto& framebuffer : targets) {
+            m_retiredFramebuffers.push_back(std::move(framebuffer));
+        }
+    }
+    m_batchFramebuffers.clear();
+    for (auto& [passName, framebuffer] : m_exportFramebuffers) {
+        m_retiredFramebuffers.push_back(std::move(framebuffer));
+    }
+    m_exportFramebuffers.clear();
+    if (m_sweepFramebuffer) {
+        m_retiredFramebuffers.push_back(std::move(m_sweepFramebuffer));
+    }
+    m_chunkProgress.clear();
+    m_tileProgress.clear();
+    m_passInputs.clear();
+    m_passOutputs.clear();
+    m_inputMipmaps.clear();
+    for (auto& [passName, refresh] : m_adaptiveRefresh) {
+        m_retiredRefresh.push_back(std::move(refresh));
+    }
+    m_adaptiveRefresh.clear();
+    for (auto& [passName, timer] : m_passTimers) {
+        m_retiredTimers.push_back(std::move(timer));
+    }
+    m_passTimers.clear();
+    m_passTimings.clear();
     
     LOG_INFO("Cleared all loaded shaders");
 }
@@ -843,29 +1923,19 @@ void ShaderManager::cleanupShader(ShaderProgram& shader) {
 }
 
 void ShaderManager::setupSimpleTextureProgram() {
-    const char* vertexSource = R"(
-        #version 330 core
-        layout (location = 0) in vec2 aPos;
-        layout (location = 1) in vec2 aTexCoord;
-        out vec2 TexCoord;
-        void main() {
-            gl_Position = vec4(aPos, 0.0, 1.0);
-            TexCoord = aTexCoord;
-        }
-    )";
-    
     const char* fragmentSource = R"(
         #version 330 core
         out vec4 FragColor;
         in vec2 TexCoord;
         uniform sampler2D screenTexture;
+        uniform vec2 sourceScale;
         void main() {
-            FragColor = texture(screenTexture, TexCoord);
+            FragColor = texture(screenTexture, TexCoord * sourceScale);
         }
     )";
     
     std::string errorLog;
-    GLuint vs = compileShader(vertexSource, GL_VERTEX_SHADER, errorLog);
+    GLuint vs = compileShader(QUAD_VERTEX_SOURCE, GL_VERTEX_SHADER, errorLog);
     if (!vs) LOG_ERROR("Failed to compile internal vertex shader: {}", errorLog);
     
     GLuint fs = compileShader(fragmentSource, GL_FRAGMENT_SHADER, errorLog);
@@ -875,14 +1945,276 @@ void ShaderManager::setupSimpleTextureProgram() {
     if (!m_simpleTextureProgram.programId) LOG_ERROR("Failed to link internal shader: {}", errorLog);
     
     m_simpleTextureProgram.textureLocation = glGetUniformLocation(m_simpleTextureProgram.programId, "screenTexture");
+    m_simpleTextureProgram.sourceScaleLocation = glGetUniformLocation(m_simpleTextureProgram.programId, "sourceScale");
     
     if (vs) glDeleteShader(vs);
     if (fs) glDeleteShader(fs);
 }
 
+void ShaderManager::setupUpscaleProgram() {
+    // Lanczos-2 resample of the valid source region. The result is clamped to the range of
+    // the four nearest source texels so that the negative lobes don't ring around hard edges.
+    const char* fragmentSource = R"(
+        #version 330 core
+        out vec4 FragColor;
+        in vec2 TexCoord;
+        uniform sampler2D sourceTexture;
+        uniform vec2 sourceSize;
+
+        float lanczos2(float x) {
+            x = abs(x);
+            if (x < 1e-5) return 1.0;
+            if (x >= 2.0) return 0.0;
+            float px = 3.14159265 * x;
+            return 2.0 * sin(px) * sin(px * 0.5) / (px * px);
+        }
+
+        void main() {
+            vec2 position = TexCoord * sourceSize - 0.5;
+            vec2 base = floor(position);
+            vec2 f = position - base;
+
+            vec3 color = vec3(0.0);
+            float weightSum = 0.0;
+            vec3 minColor = vec3(1e9);
+            vec3 maxColor = vec3(-1e9);
+            for (int y = -1; y <= 2; y++) {
+                float wy = lanczos2(float(y) - f.y);
+                for (int x = -1; x <= 2; x++) {
+                    ivec2 texel = ivec2(clamp(base + vec2(x, y), vec2(0.0), sourceSize - 1.0));
+                    vec3 c = texelFetch(sourceTexture, texel, 0).rgb;
+                    float w = lanczos2(float(x) - f.x) * wy;
+                    color += c * w;
+                    weightSum += w;
+                    if (x >= 0 && x <= 1 && y >= 0 && y <= 1) {
+                        minColor = min(minColor, c);
+                        maxColor = max(maxColor, c);
+                    }
+                }
+            }
+            FragColor = vec4(clamp(color / weightSum, minColor, maxColor), 1.0);
+        }
+    )";
+
+    std::string errorLog;
+    GLuint vs = compileShader(QUAD_VERTEX_SOURCE, GL_VERTEX_SHADER, errorLog);
+    if (!vs) LOG_ERROR("Failed to compile internal vertex shader: {}", errorLog);
+
+    GLuint fs = compileShader(fragmentSource, GL_FRAGMENT_SHADER, errorLog);
+    if (!fs) LOG_ERROR("Failed to compile upscale fragment shader: {}", errorLog);
+
+    m_upscaleProgram.programId = linkProgram(vs, fs, errorLog);
+    if (!m_upscaleProgram.programId) LOG_ERROR("Failed to link upscale shader: {}", errorLog);
+
+    m_upscaleProgram.textureLocation = glGetUniformLocation(m_upscaleProgram.programId, "sourceTexture");
+    m_upscaleProgram.sourceSizeLocation = glGetUniformLocation(m_upscaleProgram.programId, "sourceSize");
+
+    if (vs) glDeleteShader(vs);
+    if (fs) glDeleteShader(fs);
+}
+
+void ShaderManager::setupScatterProgram() {
+    // One point per texel of the scatter target, placed on the frame pixel it was rendered for
+    const char* vertexSource = R"(
+        #version 330 core
+        uniform sampler2D sourceTexture;
+        uniform ivec2 sourceSize;
+        uniform int stride;
+        uniform ivec2 phaseOffset;
+        uniform vec2 targetSize;
+        flat out vec4 color;
+        void main() {
+            ivec2 source = ivec2(gl_VertexID % sourceSize.x, gl_VertexID / sourceSize.x);
+            vec2 target = vec2(source * stride + phaseOffset) + 0.5;
+            gl_Position = vec4(target / targetSize * 2.0 - 1.0, 0.0, 1.0);
+            color = texelFetch(sourceTexture, source, 0);
+        }
+    )";
+
+    const char* fragmentSource = R"(
+        #version 330 core
+        flat in vec4 color;
+        out vec4 FragColor;
+        void main() {
+            FragColor = color;
+        }
+    )";
+
+    std::string errorLog;
+    GLuint vs = compileShader(vertexSource, GL_VERTEX_SHADER, errorLog);
+    if (!vs) LOG_ERROR("Failed to compile scatter vertex shader: {}", errorLog);
+
+    GLuint fs = compileShader(fragmentSource, GL_FRAGMENT_SHADER, errorLog);
+    if (!fs) LOG_ERROR("Failed to compile scatter fragment shader: {}", errorLog);
+
+    m_scatterProgram.programId = linkProgram(vs, fs, errorLog);
+    if (!m_scatterProgram.programId) LOG_ERROR("Failed to link scatter shader: {}", errorLog);
+
+    m_scatterProgram.textureLocation = glGetUniformLocation(m_scatterProgram.programId, "sourceTexture");
+    m_scatterProgram.sourceSizeLocation = glGetUniformLocation(m_scatterProgram.programId, "sourceSize");
+    m_scatterProgram.strideLocation = glGetUniformLocation(m_scatterProgram.programId, "stride");
+    m_scatterProgram.phaseOffsetLocation = glGetUniformLocation(m_scatterProgram.programId, "phaseOffset");
+    m_scatterProgram.targetSizeLocation = glGetUniformLocation(m_scatterProgram.programId, "targetSize");
+
+    if (vs) glDeleteShader(vs);
+    if (fs) glDeleteShader(fs);
+}
+
+void ShaderManager::setupChangeProgram() {
+    // Fullscreen triangle generated from gl_VertexID
+    const char* vertexSource = R"(
+        #version 330 core
+        void main() {
+            vec2 position = vec2((gl_VertexID << 1) & 2, gl_VertexID & 2);
+            gl_Position = vec4(position * 2.0 - 1.0, 0.0, 1.0);
+        }
+    )";
+
+    // Mean absolute difference of a tile, sampled on a regular grid. Samples are moved onto
+    // the measured phase (2x2 blocks of the chunk stipple pattern), whose pixels were redrawn.
+    // The square root is stored for precision, AdaptiveRefresh::poll() squares it again.
+    std::string fragmentSource = R"(
+        #version 330 core
+        uniform sampler2D currentTexture;
+        uniform sampler2D previousTexture;
+        uniform ivec4 tileRect;
+        uniform ivec3 phase;
+        out vec4 FragColor;
+        void main() {
+            int block = phase.x > 1 ? 2 : 1;
+            int period = phase.x * block;
+            ivec2 tileEnd = tileRect.xy + tileRect.zw;
+            float sum = 0.0;
+            int count = 0;
+            for (int y = 0; y < SAMPLES; y++) {
+                for (int x = 0; x < SAMPLES; x++) {
+                    ivec2 p = tileRect.xy + (ivec2(x, y) * 2 + 1) * tileRect.zw / (2 * SAMPLES);
+                    ivec2 cell = p / block;
+                    p = (cell - cell % phase.x + phase.yz) * block + p % block;
+                    p += ivec2(lessThan(p, tileRect.xy)) * period;
+                    if (any(greaterThanEqual(p, tileEnd))) continue;
+                    vec3 d = abs(texelFetch(currentTexture, p, 0).rgb - texelFetch(previousTexture, p, 0).rgb);
+                    sum += (d.r + d.g + d.b) / 3.0;
+                    count++;
+                }
+            }
+            FragColor = vec4(vec3(count > 0 ? sqrt(sum / float(count)) : 0.0), 1.0);
+        }
+    )";
+    fragmentSource.replace(fragmentSource.find("#version 330 core") + 17, 0,
+                           "\n        #define SAMPLES " + std::to_string(CHANGE_SAMPLES));
+
+    std::string errorLog;
+    GLuint vs = compileShader(vertexSource, GL_VERTEX_SHADER, errorLog);
+    if (!vs) LOG_ERROR("Failed to compile change vertex shader: {}", errorLog);
+
+    GLuint fs = compileShader(fragmentSource, GL_FRAGMENT_SHADER, errorLog);
+    if (!fs) LOG_ERROR("Failed to compile change fragment shader: {}", errorLog);
+
+    m_changeProgram.programId = linkProgram(vs, fs, errorLog);
+    if (!m_changeProgram.programId) LOG_ERROR("Failed to link change shader: {}", errorLog);
+
+    m_changeProgram.currentLocation = glGetUniformLocation(m_changeProgram.programId, "currentTexture");
+    m_changeProgram.previousLocation = glGetUniformLocation(m_changeProgram.programId, "previousTexture");
+    m_changeProgram.tileRectLocation = glGetUniformLocation(m_changeProgram.programId, "tileRect");
+    m_changeProgram.phaseLocation = glGetUniformLocation(m_changeProgram.programId, "phase");
+
+    if (vs) glDeleteShader(vs);
+    if (fs) glDeleteShader(fs);
+}
+
+void ShaderManager::scatterPhase(const std::string& name, int width, int height, int stride, int offsetX, int offsetY) {
+    int sourceWidth = (width - offsetX + stride - 1) / stride;
+    int sourceHeight = (height - offsetY + stride - 1) / stride;
+    if (sourceWidth <= 0 || sourceHeight <= 0) return;
+
+    Framebuffer& target = *m_framebuffers[name];
+    Framebuffer& scatter = *m_scatterFramebuffers[name];
+    target.bind();
+    glViewport(0, 0, width, height);
+    glUseProgram(m_scatterProgram.programId);
+
+    glActiveTexture(GL_TEXTURE0);
+    glUniform1i(m_scatterProgram.textureLocation, 0);
+    glUniform2i(m_scatterProgram.sourceSizeLocation, sourceWidth, sourceHeight);
+    glUniform1i(m_scatterProgram.strideLocation, stride);
+    glUniform2i(m_scatterProgram.phaseOffsetLocation, offsetX, offsetY);
+    glUniform2f(m_scatterProgram.targetSizeLocation, static_cast<float>(width), static_cast<float>(height));
+
+    // Vertex positions come from gl_VertexID, the bound VAO only satisfies the core profile.
+    // Each attachment of a pass with several outputs is scattered separately.
+    glBindVertexArray(m_quadVAO);
+    int attachments = target.getAttachmentCount();
+    for (int i = 0; i < attachments; i++) {
+        if (attachments > 1) {
+            target.selectAttachment(i);
+        }
+        glBindTexture(GL_TEXTURE_2D, scatter.getTextureId(i));
+        glDrawArrays(GL_POINTS, 0, sourceWidth * sourceHeight);
+    }
+    if (attachments > 1) {
+        target.selectAttachment(-1);
+    }
+    glBindVertexArray(0);
+
+    target.unbind();
+}
+
+void ShaderManager::drawUpscaled(GLuint sourceTexture, int sourceWidth, int sourceHeight, int textureWidth, int textureHeight) {
+    // Draws the bottom-left sourceWidth x sourceHeight region of the texture over the
+    // whole bound target, with the filter selected in the settings
+    bool lanczos = Settings::getInstance().getUpscaleFilter() == UpscaleFilter::Lanczos
+                   && m_upscaleProgram.programId != 0;
+
+    glActiveTexture(GL_TEXTURE0);
+    glBindTexture(GL_TEXTURE_2D, sourceTexture);
+    if (lanczos) {
+        glUseProgram(m_upscaleProgram.programId);
+        glUniform1i(m_upscaleProgram.textureLocation, 0);
+        glUniform2f(m_upscaleProgram.sourceSizeLocation, static_cast<float>(sourceWidth), static_cast<float>(sourceHeight));
+    } else {
+        glUseProgram(m_simpleTextureProgram.programId);
+        glUniform1i(m_simpleTextureProgram.textureLocation, 0);
+        glUniform2f(m_simpleTextureProgram.sourceScaleLocation,
+                    static_cast<float>(sourceWidth) / static_cast<float>(textureWidth),
+                    static_cast<float>(sourceHeight) / static_cast<float>(textureHeight));
+    }
+
+    glBindVertexArray(m_quadVAO);
+    glDrawArrays(GL_TRIANGLES, 0, 6);
+    glBindVertexArray(0);
+}
+
+void ShaderManager::upscaleToDisplay(const std::string& name, int width, int height, int sourceWidth, int sourceHeight) {
+    Framebuffer& source = *m_framebuffers[name];
+    auto& display = m_displayFramebuffers[name];
+    if (!display) {
+        display = std::make_unique<Framebuffer>(width, height, source.getFormats());
+    } else {
+        if (display->getWidth() != width || display->getHeight() != height) {
+            display->resize(width, height);
+        }
+        display->setFormats(source.getFormats());
+    }
+
+    display->bind();
+    glViewport(0, 0, width, height);
+    int attachments = source.getAttachmentCount();
+    for (int i = 0; i < attachments; i++) {
+        if (attachments > 1) {
+            display->selectAttachment(i);
+        }
+        drawUpscaled(source.getTextureId(i), sourceWidth, sourceHeight, width, height);
+    }
+    if (attachments > 1) {
+        display->selectAttachment(-1);
+    }
+    display->unbind();
+
+    m_displayValid[name] = true;
+}
+
 void ShaderManager::performUpscale(const std::string& name, int width, int height, float scaleX, float scaleY) {
-    if (m_simpleTextureProgram.programId == 0) return;
-    
     auto it = m_framebuffers.find(name);
     if (it == m_framebuffers.end()) return;
     
@@ -891,32 +2223,64 @@ void ShaderManager::performUpscale(const std::string& name, int width, int heigh
     
     if (srcW <= 0 || srcH <= 0) return;
 
-    // Create temp texture
-    GLuint tempTex;
-    glGenTextures(1, &tempTex);
-    glBindTexture(GL_TEXTURE_2D, tempTex);
-    glTexImage2D(GL_TEXTURE_2D, 0, GL_RGB, srcW, srcH, 0, GL_RGB, GL_UNSIGNED_BYTE, nullptr);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
-    
-    // Copy valid region from FBO to temp texture
-    it->second->bind();
-    glCopyTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, 0, 0, srcW, srcH);
-    
-    // Render temp texture to full FBO
-    glViewport(0, 0, width, height);
-    glUseProgram(m_simpleTextureProgram.programId);
-    
-    glActiveTexture(GL_TEXTURE0);
-    glBindTexture(GL_TEXTURE_2D, tempTex);
-    glUniform1i(m_simpleTextureProgram.textureLocation, 0);
-    
-    glBindVertexArray(m_quadVAO);
-    glDrawArrays(GL_TRIANGLES, 0, 6);
-    
-    it->second->unbind();
-    
-    glDeleteTextures(1, &tempTex);
+    auto displayIt = m_displayFramebuffers.find(name);
+    if (displayIt != m_displayFramebuffers.end() && m_displayValid[name]
+        && displayIt->second->getWidth() == width && displayIt->second->getHeight() == height) {
+        // The last reduced-scale frame was already upscaled for display, copy it over
+        Framebuffer& display = *displayIt->second;
+        int attachments = it->second->getAttachmentCount();
+        for (int i = 0; i < attachments; i++) {
+            if (attachments > 1) {
+                display.selectAttachment(i);
+                it->second->selectAttachment(i);
+            }
+            glBindFramebuffer(GL_READ_FRAMEBUFFER, display.getFramebufferId());
+            glBindFramebuffer(GL_DRAW_FRAMEBUFFER, it->second->getFramebufferId());
+            glBlitFramebuffer(0, 0, width, height, 0, 0, width, height, GL_COLOR_BUFFER_BIT, GL_NEAREST);
+        }
+        if (attachments > 1) {
+            display.selectAttachment(-1);
+            it->second->selectAttachment(-1);
+        }
+        glBindFramebuffer(GL_FRAMEBUFFER, 0);
+    } else {
+        if (m_simpleTextureProgram.programId == 0) return;
+
+        // The source region can't be sampled while drawing into the same framebuffer, so it
+        // is copied to a scratch target that only ever grows
+        Framebuffer& target = *it->second;
+        if (!m_upscaleScratch) {
+            m_upscaleScratch = std::make_unique<Framebuffer>(srcW, srcH, target.getFormats());
+        } else {
+            if (m_upscaleScratch->getWidth() < srcW || m_upscaleScratch->getHeight() < srcH) {
+                m_upscaleScratch->resize(std::max(srcW, m_upscaleScratch->getWidth()),
+                                         std::max(srcH, m_upscaleScratch->getHeight()));
+            }
+            m_upscaleScratch->setFormats(target.getFormats());
+        }
+
+        // Copy each attachment to the scratch target and render it back over the full FBO
+        int attachments = target.getAttachmentCount();
+        for (int i = 0; i < attachments; i++) {
+            if (attachments > 1) {
+                m_upscaleScratch->selectAttachment(i);
+                target.selectAttachment(i);
+            }
+            glBindFramebuffer(GL_READ_FRAMEBUFFER, target.getFramebufferId());
+            glBindFramebuffer(GL_DRAW_FRAMEBUFFER, m_upscaleScratch->getFramebufferId());
+            glBlitFramebuffer(0, 0, srcW, srcH, 0, 0, srcW, srcH, GL_COLOR_BUFFER_BIT, GL_NEAREST);
+
+            glBindFramebuffer(GL_FRAMEBUFFER, target.getFramebufferId());
+            glViewport(0, 0, width, height);
+            drawUpscaled(m_upscaleScratch->getTextureId(i), srcW, srcH,
+                         m_upscaleScratch->getWidth(), m_upscaleScratch->getHeight());
+        }
+        if (attachments > 1) {
+            m_upscaleScratch->selectAttachment(-1);
+            target.selectAttachment(-1);
+        }
+        target.unbind();
+    }
     
     // Update scale to 1.0 since we filled the buffer
     m_framebufferScales[name] = {1.0f, 1.0f};
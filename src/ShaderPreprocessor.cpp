@@ -38,8 +38,68 @@ ShaderPreprocessor::PreprocessResult ShaderPreprocessor::preprocess(const std::s
         result.includedFiles.push_back(file);
     }
     
+    bool fragment = filePath.find(".frag") != std::string::npos;
+
+    // Shift metadata after an injection point
+    auto shiftMetadata = [&](int fromLine, int delta) {
+        for (auto& range : result.uniformRanges) {
+            if (range.line >= fromLine) range.line += delta;
+        }
+        for (auto& change : result.groupChanges) {
+            if (change.line >= fromLine) change.line += delta;
+        }
+        for (auto& mapping : result.lineMappings) {
+            if (mapping.preprocessedLine >= fromLine) mapping.preprocessedLine += delta;
+        }
+    };
+
+    // A shader may redeclare gl_FragCoord (origin_upper_left, pixel_center_integer). The
+    // injected code reads gl_FragCoord, which GLSL only allows after the redeclaration.
+    static const std::regex fragCoordRedeclaration(R"(\bin\s+(?:(?:highp|mediump|lowp)\s+)?vec4\s+gl_FragCoord\s*;)");
+    std::smatch redeclaration;
+    bool redeclaresFragCoord = fragment && std::regex_search(result.source, redeclaration, fragCoordRedeclaration);
+    size_t redeclarationEnd = redeclaresFragCoord ? redeclaration.position() + redeclaration.length() : 0;
+
+    // Insert code after the version directive (or the gl_FragCoord redeclaration)
+    auto insertAfterVersion = [&](const std::string& code) {
+        int insertedLines = std::count(code.begin(), code.end(), '\n');
+        size_t anchorPos = redeclaresFragCoord ? redeclarationEnd : result.source.find("#version");
+        int insertionLine = 1;
+
+        if (anchorPos != std::string::npos) {
+            size_t eolPos = result.source.find('\n', anchorPos);
+            if (eolPos != std::string::npos) {
+                result.source.insert(eolPos + 1, code);
+                insertionLine = std::count(result.source.begin(), result.source.begin() + eolPos, '\n') + 2;
+            }
+        } else {
+            result.source.insert(0, code);
+            insertionLine = 1;
+        }
+
+        shiftMetadata(insertionLine, insertedLines);
+    };
+
+    // Preview zoom and pan and scatter chunk rendering map the pixels drawn to other pixels
+    // of a (virtual) image. Injected before the chunk logic is, so that it ends up after it
+    // in the source and chunk stippling keeps working on physical pixels. A redeclared
+    // gl_FragCoord can't be replaced by a macro, such shaders only get the uniforms and
+    // are drawn unmapped.
+    if (fragment) {
+        result.fragCoordMapped = !redeclaresFragCoord;
+        std::string mapping = R"(
+// Pixel coordinate mapping (preview zoom and pan, scatter chunk rendering)
+uniform vec2 u_view_scale;
+uniform vec2 u_view_offset;
+)";
+        if (result.fragCoordMapped) {
+            mapping += "#define gl_FragCoord vec4(gl_FragCoord.xy * u_view_scale + u_view_offset, gl_FragCoord.zw)\n";
+        }
+        insertAfterVersion(mapping);
+    }
+    
     // Conditional Chunk Logic Injection
-    if ((scaleMode == RenderScaleMode::Chunk || scaleMode == RenderScaleMode::Auto) && filePath.find(".frag") != std::string::npos) {
+    if ((scaleMode == RenderScaleMode::Chunk || scaleMode == RenderScaleMode::Auto) && fragment) {
         std::string chunkUniforms = R"(
 // Chunk rendering uniforms
 uniform bool u_progressive_fill;
@@ -60,35 +120,7 @@ bool shouldDiscard() {
 )";
         
         // Insert uniforms and helper function after version directive
-        int insertedLines = std::count(chunkUniforms.begin(), chunkUniforms.end(), '\n');
-        size_t versionPos = result.source.find("#version");
-        int insertionLine = 1;
-
-        if (versionPos != std::string::npos) {
-            size_t eolPos = result.source.find('\n', versionPos);
-            if (eolPos != std::string::npos) {
-                result.source.insert(eolPos + 1, chunkUniforms);
-                insertionLine = 2; // Inserted after line 1
-            }
-        } else {
-            result.source.insert(0, chunkUniforms);
-            insertionLine = 1;
-        }
-
-        // Shift metadata after the injection point
-        auto shiftMetadata = [&](int fromLine, int delta) {
-            for (auto& range : result.uniformRanges) {
-                if (range.line >= fromLine) range.line += delta;
-            }
-            for (auto& change : result.groupChanges) {
-                if (change.line >= fromLine) change.line += delta;
-            }
-            for (auto& mapping : result.lineMappings) {
-                if (mapping.preprocessedLine >= fromLine) mapping.preprocessedLine += delta;
-            }
-        };
-
-        shiftMetadata(insertionLine, insertedLines);
+        insertAfterVersion(chunkUniforms);
         
         // Insert discard check at start of main
         std::regex mainRegex(R"(void\s+main\s*\(\s*\)\s*\{)");
@@ -334,6 +366,12 @@ std::string ShaderPreprocessor::preprocessSource(const std::string& source,
                 std::string libInclude = matches[1].str();
                 std::string quoteInclude = matches[2].str();
                 std::string bareInclude = matches[3].str();
+
+                // #pragma include("<lib.glsl>") names a library as well
+                if (quoteInclude.size() > 2 && quoteInclude.front() == '<' && quoteInclude.back() == '>') {
+                    libInclude = quoteInclude.substr(1, quoteInclude.size() - 2);
+                    quoteInclude.clear();
+                }
                 
                 std::string includeFileName;
                 if (!libInclude.empty()) includeFileName = libInclude;
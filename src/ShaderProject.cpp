@@ -237,7 +237,44 @@ bool ShaderProject::parseManifestJson(const std::string& jsonContent) {
                 pass.fragmentShader = passJson.value("fragmentShader", "");
                 pass.width = passJson.value("width", 0);
                 pass.height = passJson.value("height", 0);
+                pass.scale = passJson.value("scale", 0.0f);
+                pass.scaleRelativeTo = passJson.value("scaleRelativeTo", "");
+                if (passJson.contains("inputs") && passJson["inputs"].is_array()) {
+                    // Either "pass", "pass.output" or {"pass": name, "output": name, "mipmap": true}
+                    for (const auto& inputJson : passJson["inputs"]) {
+                        ShaderPassInput input;
+                        if (inputJson.is_string()) {
+                            input.pass = inputJson.get<std::string>();
+                            size_t dot = input.pass.find('.');
+                            if (dot != std::string::npos) {
+                                input.output = input.pass.substr(dot + 1);
+                                input.pass = input.pass.substr(0, dot);
+                            }
+                        } else if (inputJson.is_object()) {
+                            input.pass = inputJson.value("pass", "");
+                            input.output = inputJson.value("output", "");
+                            input.mipmap = inputJson.value("mipmap", false);
+                        }
+                        if (!input.pass.empty()) {
+                            pass.inputs.push_back(input);
+                        }
+                    }
+                }
+                if (passJson.contains("outputs") && passJson["outputs"].is_array()) {
+                    // Either a name or {"name": name, "format": "rgba16f"}
+                    for (const auto& outputJson : passJson["outputs"]) {
+                        ShaderPassOutput output;
+                        if (outputJson.is_string()) {
+                            output.name = outputJson.get<std::string>();
+                        } else if (outputJson.is_object()) {
+                            output.name = outputJson.value("name", "");
+                            output.format = outputJson.value("format", "rgb8");
+                        }
+                        pass.outputs.push_back(output);
+                    }
+                }
                 pass.enabled = passJson.value("enabled", true);
+                pass.pinScale = passJson.value("pinScale", false);
                 m_manifest.passes.push_back(pass);
             }
         }
@@ -276,7 +313,32 @@ std::string ShaderProject::generateManifestJson() const {
         if (pass.height > 0) {
             passJson["height"] = pass.height;
         }
+        if (pass.scale > 0.0f) {
+            passJson["scale"] = pass.scale;
+        }
+        if (!pass.scaleRelativeTo.empty()) {
+            passJson["scaleRelativeTo"] = pass.scaleRelativeTo;
+        }
+        if (!pass.inputs.empty()) {
+            passJson["inputs"] = json::array();
+            for (const auto& input : pass.inputs) {
+                if (input.mipmap) {
+                    passJson["inputs"].push_back({{"pass", input.pass}, {"output", input.output}, {"mipmap", true}});
+                } else {
+                    passJson["inputs"].push_back(input.output.empty() ? input.pass : input.pass + "." + input.output);
+                }
+            }
+        }
+        if (!pass.outputs.empty()) {
+            passJson["outputs"] = json::array();
+            for (const auto& output : pass.outputs) {
+                passJson["outputs"].push_back({{"name", output.name}, {"format", output.format}});
+            }
+        }
         passJson["enabled"] = pass.enabled;
+        if (pass.pinScale) {
+            passJson["pinScale"] = true;
+        }
         j["passes"].push_back(passJson);
     }
     
@@ -387,8 +449,28 @@ bool ShaderProject::loadShadersIntoManager(std::shared_ptr<ShaderManager> shader
     
     RenderScaleMode scaleMode = Settings::getInstance().getRenderScaleMode();
 
+    // Inputs are read from whatever the input pass rendered last, so they have to be enabled
+    // passes that render earlier in the frame
+    std::unordered_set<std::string> renderedPasses;
     for (const auto& pass : m_manifest.passes) {
         if (!pass.enabled) continue;
+
+        for (const auto& input : pass.inputs) {
+            if (input.pass == pass.name || renderedPasses.count(input.pass)) {
+                continue;
+            }
+            auto inputIt = std::find_if(m_manifest.passes.begin(), m_manifest.passes.end(), [&input](const ShaderPass& other) {
+                return other.name == input.pass;
+            });
+            if (inputIt == m_manifest.passes.end()) {
+                LOG_WARN("Pass '{}' reads unknown pass '{}'", pass.name, input.pass);
+            } else if (!inputIt->enabled) {
+                LOG_WARN("Pass '{}' reads disabled pass '{}'", pass.name, input.pass);
+            } else {
+                LOG_WARN("Pass '{}' reads pass '{}', which renders after it, move the input earlier in the pass list", pass.name, input.pass);
+            }
+        }
+        renderedPasses.insert(pass.name);
         
         std::string vertPath = getShaderPath(pass.vertexShader);
         std::string fragPath = getShaderPath(pass.fragmentShader);
@@ -401,6 +483,8 @@ bool ShaderProject::loadShadersIntoManager(std::shared_ptr<ShaderManager> shader
 
         // Apply saved uniform values
         applyUniformsToShader(pass.name, shader);
+        shaderManager->setPassInputs(pass.name, pass.inputs);
+        shaderManager->setPassOutputs(pass.name, pass.outputs);
     }
     
     return true;
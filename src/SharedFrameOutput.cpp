@@ -0,0 +1,253 @@
+#include "SharedFrameOutput.h"
+#include "Logger.h"
+#include <algorithm>
+#include <chrono>
+#include <cerrno>
+#include <climits>
+#include <cstring>
+
+#include <fcntl.h>
+#include <linux/futex.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+static const char SHARED_FRAME_MAGIC[8] = { 'F', 'O', 'R', 'K', 'E', 'A', 'T', '\0' };
+
+// Slots start on page boundaries, so each frame's pages are committed independently
+static const size_t SHARED_FRAME_PAGE = 4096;
+
+static size_t alignToPage(size_t size) {
+    return (size + SHARED_FRAME_PAGE - 1) / SHARED_FRAME_PAGE * SHARED_FRAME_PAGE;
+}
+
+static std::string getObjectName(const std::string& name) {
+    return !name.empty() && name[0] == '/' ? name : "/" + name;
+}
+
+// The mapping is shared between processes, so the futex must not be process-private
+static void wakeFutex(std::atomic<uint32_t>* word) {
+    syscall(SYS_futex, reinterpret_cast<uint32_t*>(word), FUTEX_WAKE, INT_MAX, nullptr, nullptr, 0);
+}
+
+static void waitFutex(std::atomic<uint32_t>* word, uint32_t expected, int timeoutMs) {
+    timespec timeout = { timeoutMs / 1000, (timeoutMs % 1000) * 1000000L };
+    syscall(SYS_futex, reinterpret_cast<uint32_t*>(word), FUTEX_WAIT, expected,
+            timeoutMs < 0 ? nullptr : &timeout, nullptr, 0);
+}
+
+SharedFrameOutput::SharedFrameOutput()
+    : m_header(nullptr)
+    , m_mappedSize(0)
+    , m_sequence(0)
+    , m_warnedTooLarge(false) {
+}
+
+SharedFrameOutput::~SharedFrameOutput() {
+    close();
+}
+
+bool SharedFrameOutput::open(const std::string& name, int slotCount, size_t maxFrameBytes) {
+    close();
+    m_name = getObjectName(name);
+    slotCount = std::max(2, slotCount);
+
+    size_t headerSize = alignToPage(sizeof(SharedFrameHeader));
+    size_t slotSize = alignToPage(sizeof(SharedFrameSlot) + maxFrameBytes);
+    size_t totalSize = headerSize + slotSize * slotCount;
+
+    // A fresh object each time, consumers of a previous run keep their old mapping
+    shm_unlink(m_name.c_str());
+    int fd = shm_open(m_name.c_str(), O_CREAT | O_EXCL | O_RDWR, 0600);
+    if (fd < 0) {
+        LOG_ERROR("Failed to create shared memory {}: {}", m_name, std::strerror(errno));
+        return false;
+    }
+    if (ftruncate(fd, static_cast<off_t>(totalSize)) != 0) {
+        LOG_ERROR("Failed to size shared memory {}: {}", m_name, std::strerror(errno));
+        ::close(fd);
+        shm_unlink(m_name.c_str());
+        return false;
+    }
+    void* mapping = mmap(nullptr, totalSize, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    ::close(fd);
+    if (mapping == MAP_FAILED) {
+        LOG_ERROR("Failed to map shared memory {}: {}", m_name, std::strerror(errno));
+        shm_unlink(m_name.c_str());
+        return false;
+    }
+
+    // ftruncate zero-fills, so every slot starts out empty (sequence 0)
+    m_header = static_cast<SharedFrameHeader*>(mapping);
+    m_mappedSize = totalSize;
+    m_sequence = 0;
+    m_warnedTooLarge = false;
+    m_header->version = SHARED_FRAME_VERSION;
+    m_header->slotCount = static_cast<uint32_t>(slotCount);
+    m_header->slotSize = slotSize;
+    m_header->headerSize = headerSize;
+
+    // The magic goes in last, a consumer that sees it sees a complete header
+    std::atomic_thread_fence(std::memory_order_release);
+    std::memcpy(m_header->magic, SHARED_FRAME_MAGIC, sizeof(SHARED_FRAME_MAGIC));
+
+    LOG_INFO("Publishing frames to shared memory {} ({} slots of up to {} bytes)", m_name, slotCount, maxFrameBytes);
+    return true;
+}
+
+void SharedFrameOutput::close() {
+    if (m_header) {
+        munmap(m_header, m_mappedSize);
+        shm_unlink(m_name.c_str());
+        m_header = nullptr;
+        m_mappedSize = 0;
+    }
+}
+
+SharedFrameSlot* SharedFrameOutput::getSlot(uint64_t sequence) const {
+    size_t index = static_cast<size_t>((sequence - 1) % m_header->slotCount);
+    unsigned char* base = reinterpret_cast<unsigned char*>(m_header) + m_header->headerSize;
+    return reinterpret_cast<SharedFrameSlot*>(base + index * m_header->slotSize);
+}
+
+bool SharedFrameOutput::publish(const unsigned char* pixels, int width, int height, uint64_t timestampNs) {
+    if (!m_header) {
+        return false;
+    }
+    size_t size = static_cast<size_t>(width) * height * 4;
+    if (size > m_header->slotSize - sizeof(SharedFrameSlot)) {
+        if (!m_warnedTooLarge) {
+            LOG_WARN("Frame of {}x{} does not fit into shared memory {}, dropping it", width, height, m_name);
+            m_warnedTooLarge = true;
+        }
+        return false;
+    }
+
+    uint64_t sequence = ++m_sequence;
+    SharedFrameSlot* slot = getSlot(sequence);
+
+    // Mark the slot as being written before any of its contents change
+    slot->sequence.store(0, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+
+    slot->timestampNs = timestampNs;
+    slot->format = SHARED_FRAME_FORMAT_RGBA8;
+    slot->width = static_cast<uint32_t>(width);
+    slot->height = static_cast<uint32_t>(height);
+    slot->stride = static_cast<uint32_t>(width) * 4;
+    slot->size = size;
+    std::memcpy(reinterpret_cast<unsigned char*>(slot) + sizeof(SharedFrameSlot), pixels, size);
+
+    slot->sequence.store(sequence, std::memory_order_release);
+    m_header->latestSequence.store(sequence, std::memory_order_release);
+    m_header->frameSignal.fetch_add(1, std::memory_order_release);
+    wakeFutex(&m_header->frameSignal);
+    return true;
+}
+
+SharedFrameReader::SharedFrameReader()
+    : m_header(nullptr)
+    , m_mappedSize(0) {
+}
+
+SharedFrameReader::~SharedFrameReader() {
+    close();
+}
+
+bool SharedFrameReader::open(const std::string& name) {
+    close();
+    std::string objectName = getObjectName(name);
+    int fd = shm_open(objectName.c_str(), O_RDONLY, 0);
+    if (fd < 0) {
+        LOG_ERROR("Failed to open shared memory {}: {}", objectName, std::strerror(errno));
+        return false;
+    }
+    struct stat info;
+    if (fstat(fd, &info) != 0 || static_cast<size_t>(info.st_size) < sizeof(SharedFrameHeader)) {
+        LOG_ERROR("Shared memory {} is not a frame output", objectName);
+        ::close(fd);
+        return false;
+    }
+    void* mapping = mmap(nullptr, static_cast<size_t>(info.st_size), PROT_READ, MAP_SHARED, fd, 0);
+    ::close(fd);
+    if (mapping == MAP_FAILED) {
+        LOG_ERROR("Failed to map shared memory {}: {}", objectName, std::strerror(errno));
+        return false;
+    }
+
+    m_header = static_cast<SharedFrameHeader*>(mapping);
+    m_mappedSize = static_cast<size_t>(info.st_size);
+    std::atomic_thread_fence(std::memory_order_acquire);
+    if (std::memcmp(m_header->magic, SHARED_FRAME_MAGIC, sizeof(SHARED_FRAME_MAGIC)) != 0
+        || m_header->version != SHARED_FRAME_VERSION
+        || m_header->headerSize + m_header->slotSize * m_header->slotCount > m_mappedSize) {
+        LOG_ERROR("Shared memory {} is not a frame output of this version", objectName);
+        close();
+        return false;
+    }
+    return true;
+}
+
+void SharedFrameReader::close() {
+    if (m_header) {
+        munmap(m_header, m_mappedSize);
+        m_header = nullptr;
+        m_mappedSize = 0;
+    }
+}
+
+bool SharedFrameReader::waitForFrame(uint64_t afterSequence, int timeoutMs) {
+    if (!m_header) {
+        return false;
+    }
+    auto deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(std::max(0, timeoutMs));
+    while (true) {
+        // Read the signal first, a frame published after the check changes it and the
+        // wait returns immediately
+        uint32_t signal = m_header->frameSignal.load(std::memory_order_acquire);
+        if (m_header->latestSequence.load(std::memory_order_acquire) > afterSequence) {
+            return true;
+        }
+
+        int remaining = -1;
+        if (timeoutMs >= 0) {
+            auto left = std::chrono::duration_cast<std::chrono::milliseconds>(deadline - std::chrono::steady_clock::now());
+            if (left.count() <= 0) {
+                return false;
+            }
+            remaining = static_cast<int>(left.count());
+        }
+        waitFutex(&m_header->frameSignal, signal, remaining);
+    }
+}
+
+bool SharedFrameReader::readLatest(Frame& frame) const {
+    if (!m_header) {
+        return false;
+    }
+    uint64_t sequence = m_header->latestSequence.load(std::memory_order_acquire);
+    if (sequence == 0) {
+        return false;
+    }
+
+    size_t index = static_cast<size_t>((sequence - 1) % m_header->slotCount);
+    const unsigned char* base = reinterpret_cast<const unsigned char*>(m_header) + m_header->headerSize;
+    const SharedFrameSlot* slot = reinterpret_cast<const SharedFrameSlot*>(base + index * m_header->slotSize);
+
+    if (slot->sequence.load(std::memory_order_acquire) != sequence) {
+        return false;
+    }
+    frame.sequence = sequence;
+    frame.timestampNs = slot->timestampNs;
+    frame.format = slot->format;
+    frame.width = static_cast<int>(slot->width);
+    frame.height = static_cast<int>(slot->height);
+    size_t size = std::min<size_t>(slot->size, m_header->slotSize - sizeof(SharedFrameSlot));
+    frame.pixels.resize(size);
+    std::memcpy(frame.pixels.data(), reinterpret_cast<const unsigned char*>(slot) + sizeof(SharedFrameSlot), size);
+
+    // Overwritten in the meantime if the producer went round the whole ring
+    std::atomic_thread_fence(std::memory_order_acquire);
+    return slot->sequence.load(std::memory_order_relaxed) == sequence;
+}
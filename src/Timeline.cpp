@@ -24,14 +24,35 @@ Timeline::Timeline()
     m_fpsData.resize(static_cast<size_t>(m_duration / m_timeSliceDuration));
 }
 
-void Timeline::addFPS(float time, float fps, float renderScaleFactor) {
+void Timeline::setDuration(float duration) {
+    m_duration = duration;
+    m_fpsData.resize(static_cast<size_t>(m_duration / m_timeSliceDuration));
+}
+
+void Timeline::addFPS(float time, float fps, float renderScaleFactor, float costPerMegapixel) {
     if (time < 0.0f || time >= m_duration) {
         return; // Time is out of bounds
     }
     size_t index = static_cast<size_t>(time / m_timeSliceDuration);
     if (index < m_fpsData.size()) {
-        m_fpsData[index] = {fps, renderScaleFactor};
+        auto& data = m_fpsData[index];
+        // Blend with the previous measurement so a single outlier doesn't dominate the slice
+        if (costPerMegapixel >= 0.0f && data.costPerMegapixel >= 0.0f) {
+            costPerMegapixel = data.costPerMegapixel * 0.5f + costPerMegapixel * 0.5f;
+        }
+        data = {fps, renderScaleFactor, costPerMegapixel};
+    }
+}
+
+float Timeline::getCostPerMegapixel(float time) const {
+    if (time < 0.0f || time >= m_duration) {
+        return -1.0f;
+    }
+    size_t index = static_cast<size_t>(time / m_timeSliceDuration);
+    if (index < m_fpsData.size()) {
+        return m_fpsData[index].costPerMegapixel;
     }
+    return -1.0f;
 }
 
 void Timeline::clearFPSData() {
@@ -60,6 +81,12 @@ void Timeline::renderTimelineBar(float renderScaleFactor) {
     // FPS graph
     float fpsGraphHeight = barHeight * 0.25f;
     ImVec2 fpsGraphStart = ImVec2(bar_start.x, bar_end.y - fpsGraphHeight);
+
+    // Thumbnails fill the bar above the FPS graph
+    bool showThumbnails = m_thumbnails.textureId != 0 && !m_thumbnails.times.empty();
+    if (showThumbnails) {
+        renderThumbnails(bar_start, ImVec2(bar_end.x, fpsGraphStart.y));
+    }
     
     float segmentWidth = bar_width / m_fpsData.size();
 
@@ -106,7 +133,8 @@ void Timeline::renderTimelineBar(float renderScaleFactor) {
     float progress = m_duration > 0.0f ? m_currentTime / m_duration : 0.0f;
     if (progress > 0.0f) {
         ImVec2 progress_end = ImVec2(bar_start.x + bar_width * progress, bar_end.y-fpsGraphHeight);
-        draw_list->AddRectFilled(bar_start, progress_end, IM_COL32(60, 150, 60, 255));
+        // Only tint the thumbnails, they should stay recognizable
+        draw_list->AddRectFilled(bar_start, progress_end, showThumbnails ? IM_COL32(60, 150, 60, 90) : IM_COL32(60, 150, 60, 255));
     }
     
     // Time markers
@@ -201,6 +229,45 @@ void Timeline::renderTimelineBar(float renderScaleFactor) {
     }
 }
 
+void Timeline::renderThumbnails(const ImVec2& stripStart, const ImVec2& stripEnd) {
+    ImDrawList* draw_list = ImGui::GetWindowDrawList();
+    float stripWidth = stripEnd.x - stripStart.x;
+    float stripHeight = stripEnd.y - stripStart.y;
+    if (stripWidth <= 0.0f || stripHeight <= 0.0f || m_duration <= 0.0f) {
+        return;
+    }
+
+    // As many slots as fit at the thumbnail aspect, each showing the rendered thumbnail
+    // closest to the time at its centre
+    int count = static_cast<int>(m_thumbnails.times.size());
+    int slots = std::max(1, static_cast<int>(stripWidth / (stripHeight * m_thumbnails.aspect)));
+    float slotWidth = stripWidth / static_cast<float>(slots);
+    float cellWidth = 1.0f / static_cast<float>(m_thumbnails.columns);
+    float cellHeight = 1.0f / static_cast<float>(m_thumbnails.rows);
+
+    for (int slot = 0; slot < slots; slot++) {
+        float time = (static_cast<float>(slot) + 0.5f) / static_cast<float>(slots) * m_duration;
+        int best = -1;
+        for (int index = 0; index < count; index++) {
+            if (m_thumbnails.ready[index]
+                && (best < 0 || std::abs(m_thumbnails.times[index] - time) < std::abs(m_thumbnails.times[best] - time))) {
+                best = index;
+            }
+        }
+        if (best < 0) {
+            return;
+        }
+
+        // Thumbnails are stored bottom row first, like any rendered texture
+        float u0 = static_cast<float>(best % m_thumbnails.columns) * cellWidth;
+        float v0 = static_cast<float>(best / m_thumbnails.columns) * cellHeight;
+        float x = stripStart.x + static_cast<float>(slot) * slotWidth;
+        draw_list->AddImage((void*)(intptr_t)m_thumbnails.textureId,
+                            ImVec2(x, stripStart.y), ImVec2(x + slotWidth, stripEnd.y),
+                            ImVec2(u0, v0 + cellHeight), ImVec2(u0 + cellWidth, v0));
+    }
+}
+
 Timeline::~Timeline() {
     // Nothing to cleanup
 }
@@ -0,0 +1,156 @@
+#include "TimelineThumbnails.h"
+#include "ShaderManager.h"
+#include "GpuTimer.h"
+#include "Logger.h"
+#include "glad.h"
+#include <algorithm>
+#include <cmath>
+
+TimelineThumbnails::TimelineThumbnails(std::shared_ptr<ShaderManager> shaderManager)
+    : m_shaderManager(shaderManager)
+    , m_thumbnailMs(0.0f) {
+    // 0, 32, 16, 48, 8, 24, 40, 56, 4, ...
+    std::vector<bool> added(THUMBNAIL_COUNT, false);
+    for (int step = THUMBNAIL_COUNT; step >= 1; step /= 2) {
+        for (int index = 0; index < THUMBNAIL_COUNT; index += step) {
+            if (!added[index]) {
+                added[index] = true;
+                m_fillOrder.push_back(index);
+            }
+        }
+    }
+}
+
+TimelineThumbnails::~TimelineThumbnails() {
+    clear();
+}
+
+void TimelineThumbnails::render(const std::vector<Pass>& passes, const std::string& outputPass, float duration, float availableMs) {
+    auto outputIt = std::find_if(passes.begin(), passes.end(), [&outputPass](const Pass& pass) {
+        return pass.name == outputPass;
+    });
+    if (outputIt == passes.end() || outputIt->width <= 0 || outputIt->height <= 0 || duration <= 0.0f) {
+        return;
+    }
+
+    if (!m_timer) {
+        m_timer = std::make_unique<GpuTimer>();
+    }
+    GpuTimer::Sample sample;
+    while (m_timer->poll(sample)) {
+        if (sample.tileCount > 0) {
+            float thumbnailMs = sample.milliseconds / static_cast<float>(sample.tileCount);
+            m_thumbnailMs = (m_thumbnailMs <= 0.0f) ? thumbnailMs : m_thumbnailMs * 0.7f + thumbnailMs * 0.3f;
+        }
+    }
+
+    // Thumbnails keep the aspect of the pass
+    int height = THUMBNAIL_HEIGHT;
+    int width = static_cast<int>(std::lround(static_cast<float>(height) * outputIt->width / outputIt->height));
+    width = std::clamp(width, 8, THUMBNAIL_HEIGHT * 4);
+
+    auto& strip = m_strips[outputPass];
+    size_t fingerprint = m_shaderManager->computeSourceFingerprint(outputPass);
+    if (strip.textureId == 0 || strip.width != width || strip.height != height) {
+        if (strip.textureId == 0) {
+            glGenTextures(1, &strip.textureId);
+        }
+        glBindTexture(GL_TEXTURE_2D, strip.textureId);
+        glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA8, width * COLUMNS, height * (THUMBNAIL_COUNT / COLUMNS), 0,
+                     GL_RGBA, GL_UNSIGNED_BYTE, nullptr);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+        glBindTexture(GL_TEXTURE_2D, 0);
+        strip.width = width;
+        strip.height = height;
+        strip.readyCount = 0;
+    } else if (fingerprint != strip.fingerprint || duration != strip.duration) {
+        strip.readyCount = 0;
+    }
+    if (strip.readyCount == 0) {
+        strip.ready.assign(THUMBNAIL_COUNT, false);
+    }
+    strip.fingerprint = fingerprint;
+    strip.duration = duration;
+    if (strip.readyCount >= THUMBNAIL_COUNT) {
+        return;
+    }
+
+    // Always one thumbnail so the strip completes even without spare budget. Until the
+    // first timing has arrived the cost is unknown.
+    int batchSize = 1;
+    if (m_thumbnailMs > 0.0f) {
+        batchSize = std::clamp(static_cast<int>(availableMs / m_thumbnailMs), 1, MAX_BATCH);
+    }
+    std::vector<int> cells;
+    std::vector<float> times;
+    for (int index : m_fillOrder) {
+        if (!strip.ready[index]) {
+            cells.push_back(index);
+            times.push_back((static_cast<float>(index) + 0.5f) * duration / THUMBNAIL_COUNT);
+            if (static_cast<int>(cells.size()) == batchSize) {
+                break;
+            }
+        }
+    }
+
+    // Every pass up to the output is rendered at the fraction of its size the thumbnail
+    // is of the output, so inputs with their own size keep their relative resolution
+    float scaleX = static_cast<float>(width) / static_cast<float>(outputIt->width);
+    float scaleY = static_cast<float>(height) / static_cast<float>(outputIt->height);
+    bool timing = m_timer->begin();
+    bool drawn = false;
+    for (auto it = passes.begin(); it != std::next(outputIt); ++it) {
+        int passWidth = std::max(1, static_cast<int>(std::lround(it->width * scaleX)));
+        int passHeight = std::max(1, static_cast<int>(std::lround(it->height * scaleY)));
+        drawn = m_shaderManager->renderPassBatch(it->name, passWidth, passHeight, times);
+    }
+    if (drawn) {
+        for (size_t i = 0; i < cells.size(); i++) {
+            int x = (cells[i] % COLUMNS) * width;
+            int y = (cells[i] / COLUMNS) * height;
+            m_shaderManager->copyBatchOutput(outputPass, i, strip.textureId, x, y);
+            strip.ready[cells[i]] = true;
+            strip.readyCount++;
+        }
+    }
+    if (timing) {
+        m_timer->end(times.front(), 1.0f, 1.0f, drawn ? static_cast<int>(cells.size()) : 0);
+    }
+
+    // The strip is drawn by the UI context, which only sees the copies once they were issued
+    glFlush();
+    if (drawn && strip.readyCount == THUMBNAIL_COUNT) {
+        LOG_DEBUG("Timeline thumbnails of {} complete", outputPass);
+    }
+}
+
+TimelineThumbnailStrip TimelineThumbnails::getStrip(const std::string& passName) const {
+    TimelineThumbnailStrip result;
+    auto it = m_strips.find(passName);
+    if (it == m_strips.end() || it->second.textureId == 0 || it->second.readyCount == 0) {
+        return result;
+    }
+
+    const Strip& strip = it->second;
+    result.textureId = strip.textureId;
+    result.columns = COLUMNS;
+    result.rows = THUMBNAIL_COUNT / COLUMNS;
+    result.aspect = static_cast<float>(strip.width) / static_cast<float>(strip.height);
+    result.ready = strip.ready;
+    for (int index = 0; index < THUMBNAIL_COUNT; index++) {
+        result.times.push_back((static_cast<float>(index) + 0.5f) * strip.duration / THUMBNAIL_COUNT);
+    }
+    return result;
+}
+
+void TimelineThumbnails::clear() {
+    for (auto& [passName, strip] : m_strips) {
+        if (strip.textureId != 0) {
+            glDeleteTextures(1, &strip.textureId);
+        }
+    }
+    m_strips.clear();
+}
@@ -7,6 +7,7 @@
 #include <memory>
 #include <chrono>
 #include <cstdlib>
+#include <stdexcept>
 
 #include "imgui/imgui.h"
 #include "imgui/backends/imgui_impl_glfw.h"
@@ -20,6 +21,8 @@
 #include "Logger.h"
 #include "Settings.h"
 #include "Timeline.h"
+#include "HeadlessRenderer.h"
+#include "RenderCoordinator.h"
 #include "GeneratedShaderLibraries.h"
 #include <filesystem>
 #include "RenderScaleMode.h"
@@ -158,6 +161,7 @@ public:
         float lastTime = 0.0f;
         
         while (m_running && !glfwWindowShouldClose(m_window)) {
+            auto frameStart = std::chrono::steady_clock::now();
             float currentTime = glfwGetTime();
             float deltaTime = currentTime - lastTime;
             lastTime = currentTime;
@@ -210,7 +214,8 @@ public:
                 glfwSetWindowShouldClose(m_window, GLFW_TRUE);
                 m_running = false;
             }
-            std::this_thread::sleep_for(std::chrono::milliseconds(16));
+            // Cap the UI at ~60 Hz, accounting for the time this frame already took
+            std::this_thread::sleep_until(frameStart + std::chrono::milliseconds(16));
         }
     }
     
@@ -224,6 +229,12 @@ public:
             m_shaderEditor->setRenderScaleFactor(scale);
         }
     }
+
+    void startRenderThread() {
+        if (m_shaderEditor) {
+            m_shaderEditor->startRenderThread();
+        }
+    }
     
     void setDumpFramebuffer(const std::string& passName, const std::string& outputPath) {
         m_dumpFramebuffer = true;
@@ -238,6 +249,16 @@ public:
     void dumpFramebuffer(const std::string& passName, const std::string& outputPath) {
         m_shaderEditor->dumpFramebuffer(passName, outputPath);
     }
+
+    bool setSharedOutput(const std::string& passName, const std::string& name) {
+        return m_shaderEditor && m_shaderEditor->setSharedOutput(passName, name);
+    }
+
+    void finishPendingWrites() {
+        if (m_shaderEditor) {
+            m_shaderEditor->finishPendingWrites();
+        }
+    }
     
     static void keyCallback(GLFWwindow* window, int key, int scancode, int action, int mods) {
         Application* app = static_cast<Application*>(glfwGetWindowUserPointer(window));
@@ -250,6 +271,7 @@ public:
         Application* app = static_cast<Application*>(glfwGetWindowUserPointer(window));
         if (app) {
             LOG_INFO("Window close requested");
+            app->finishPendingWrites();
             std::exit(0);  // Immediate exit to avoid cleanup hanging
         }
     }
@@ -264,6 +286,7 @@ public:
         if (action == GLFW_PRESS) {
             if (key == GLFW_KEY_ESCAPE) {
                 LOG_INFO("ESC pressed - exiting");
+                finishPendingWrites();
                 std::exit(0);  // Immediate exit to avoid cleanup hanging
             }
         }
@@ -302,6 +325,9 @@ public:
 private:
     
     void cleanup() {
+        // Screenshots and dumps may still be in flight, they are written before exiting
+        finishPendingWrites();
+
         if (m_testMode) {
             // In test mode, skip all cleanup to avoid hanging and exit immediately
             std::exit(m_testExitCode);
@@ -352,6 +378,8 @@ int main(int argc, char* argv[]) {
     int testExitCode = 0;
     bool debugMode = false;
     bool dumpFramebuffer = false;
+    std::string sharedOutputPass;
+    std::string sharedOutputName;
     std::string dumpPassName;
     std::string dumpOutputPath;
     std::string shaderProjectPath;
@@ -365,6 +393,13 @@ int main(int argc, char* argv[]) {
     RenderScaleMode customRenderScaleMode = RenderScaleMode::Resolution;
     bool overrideRenderScale = false;
     float customRenderScale = 1.0f;
+    bool useRenderThread = false;
+    bool renderSequence = false;
+    HeadlessRenderer::SequenceOptions sequenceOptions;
+    int renderWorkers = -1;
+    bool sequenceWorker = false;
+    bool renderPoster = false;
+    HeadlessRenderer::PosterOptions posterOptions;
     
     // Parse command line arguments
     for (int i = 1; i < argc; i++) {
@@ -383,8 +418,10 @@ int main(int argc, char* argv[]) {
                 customRenderScaleMode = RenderScaleMode::Chunk;
             } else if (modeStr == "resolution") {
                 customRenderScaleMode = RenderScaleMode::Resolution;
+            } else if (modeStr == "tiled") {
+                customRenderScaleMode = RenderScaleMode::Tiled;
             } else {
-                LOG_ERROR("Invalid render scale mode: {}. Use 'chunk' or 'resolution'.", modeStr);
+                LOG_ERROR("Invalid render scale mode: {}. Use 'chunk', 'resolution' or 'tiled'.", modeStr);
                 return 1;
             }
             overrideRenderScaleMode = true;
@@ -404,6 +441,9 @@ int main(int argc, char* argv[]) {
                 return 1;
             }
         }
+        else if (arg == "--render-thread") {
+            useRenderThread = true;
+        }
         else if (arg == "--test") {
             testMode = true;
             // Check if next argument is an exit code
@@ -461,6 +501,78 @@ int main(int argc, char* argv[]) {
             dumpOutputPath = argv[i + 2];
             i += 2;
         }
+        else if (arg == "--shared-output" && i + 2 < argc) {
+            sharedOutputPass = argv[i + 1];
+            sharedOutputName = argv[i + 2];
+            i += 2;
+        }
+        else if (arg == "--render-sequence" && i + 5 < argc) {
+            try {
+                sequenceOptions.startTime = std::stof(argv[i + 1]);
+                sequenceOptions.endTime = std::stof(argv[i + 2]);
+                sequenceOptions.fps = std::stof(argv[i + 3]);
+                std::string size = argv[i + 4];
+                size_t separator = size.find('x');
+                if (separator == std::string::npos) {
+                    throw std::invalid_argument(size);
+                }
+                sequenceOptions.width = std::stoi(size.substr(0, separator));
+                sequenceOptions.height = std::stoi(size.substr(separator + 1));
+                sequenceOptions.output = argv[i + 5];
+                renderSequence = true;
+                i += 5;
+            } catch (const std::exception&) {
+                LOG_ERROR("Invalid --render-sequence arguments, expected <start> <end> <fps> <WxH> <output>");
+                return 1;
+            }
+        }
+        else if (arg == "--render-poster" && i + 4 < argc) {
+            try {
+                posterOptions.time = std::stof(argv[i + 1]);
+                std::string size = argv[i + 2];
+                size_t separator = size.find('x');
+                if (separator == std::string::npos) {
+                    throw std::invalid_argument(size);
+                }
+                posterOptions.width = std::stoi(size.substr(0, separator));
+                posterOptions.height = std::stoi(size.substr(separator + 1));
+                posterOptions.supersample = std::stoi(argv[i + 3]);
+                posterOptions.output = argv[i + 4];
+                renderPoster = true;
+                i += 4;
+            } catch (const std::exception&) {
+                LOG_ERROR("Invalid --render-poster arguments, expected <time> <WxH> <supersample> <output.png>");
+                return 1;
+            }
+        }
+        else if (arg == "--sequence-format" && i + 1 < argc) {
+            if (!FrameEncoder::parseFormat(argv[i + 1], sequenceOptions.format)) {
+                LOG_ERROR("Invalid sequence format: {}. Use png, y4m or rgba", argv[i + 1]);
+                return 1;
+            }
+            i++;
+        }
+        else if (arg == "--encode-threads" && i + 1 < argc) {
+            try {
+                sequenceOptions.encodeThreads = std::stoi(argv[i + 1]);
+                i++;
+            } catch (const std::exception&) {
+                LOG_ERROR("Invalid encoder thread count: {}", argv[i + 1]);
+                return 1;
+            }
+        }
+        else if (arg == "--render-workers" && i + 1 < argc) {
+            try {
+                renderWorkers = std::stoi(argv[i + 1]);
+                i++;
+            } catch (const std::exception&) {
+                LOG_ERROR("Invalid render worker count: {}", argv[i + 1]);
+                return 1;
+            }
+        }
+        else if (arg == "--sequence-worker") {
+            sequenceWorker = true;
+        }
         else if (!arg.empty() && arg[0] != '-') {
             // This is a shader project path
             if (shaderProjectPath.empty()) {
@@ -478,8 +590,21 @@ int main(int argc, char* argv[]) {
         }
     }
     
+    // A video stream on stdout must not be interleaved with log messages
+    if (renderSequence && sequenceOptions.format != FrameEncoder::Format::Png && sequenceOptions.output == "-") {
+        Logger::getInstance().setLogToStderr(true);
+    }
+    // Worker processes report progress to the coordinator on stdout
+    if (sequenceWorker) {
+        Logger::getInstance().setLogToStderr(true);
+    }
+
     // Initialize logger early so it can be used throughout
     Logger::getInstance().initialize(debugMode);
+    if (sequenceWorker && !debugMode) {
+        // The coordinator reports progress for all workers
+        Logger::getInstance().setLogLevel(LogLevel::WARN);
+    }
     LOG_INFO("Fork Eater - Compiled on {} at {}", __DATE__, __TIME__);
 
     if (debugMode) {
@@ -549,6 +674,34 @@ int main(int argc, char* argv[]) {
         }
     }
     
+    // Offline rendering needs neither a window nor ImGui
+    if (renderSequence && sequenceWorker) {
+        return RenderCoordinator::runWorker(shaderProjectPath, sequenceOptions) ? 0 : 1;
+    }
+    if (renderSequence && renderWorkers >= 0) {
+        RenderCoordinator coordinator(argv[0], renderWorkers);
+        if (!coordinator.renderSequence(shaderProjectPath, sequenceOptions, debugMode)) {
+            return 1;
+        }
+        if (!renderPoster) {
+            return 0;
+        }
+        renderSequence = false;
+    }
+    if (renderSequence || renderPoster) {
+        HeadlessRenderer renderer;
+        if (!renderer.initialize()) {
+            return 1;
+        }
+        if (renderSequence && !renderer.renderSequence(shaderProjectPath, sequenceOptions)) {
+            return 1;
+        }
+        if (renderPoster && !renderer.renderPoster(shaderProjectPath, posterOptions)) {
+            return 1;
+        }
+        return 0;
+    }
+
     if (testMode) {
         app.setTestMode(true, testExitCode);
         // In test mode, use basic shader if no project specified
@@ -566,8 +719,10 @@ int main(int argc, char* argv[]) {
     
     if (overrideRenderScaleMode) {
         settings.setRenderScaleMode(customRenderScaleMode);
-        LOG_INFO("Render scale mode set to {} via command line", 
-                 (customRenderScaleMode == RenderScaleMode::Chunk ? "Chunk" : "Resolution"));
+        const char* modeName = "Resolution";
+        if (customRenderScaleMode == RenderScaleMode::Chunk) modeName = "Chunk";
+        else if (customRenderScaleMode == RenderScaleMode::Tiled) modeName = "Tiled";
+        LOG_INFO("Render scale mode set to {} via command line", modeName);
     }
 
     if (overrideRenderScale) {
@@ -593,6 +748,14 @@ int main(int argc, char* argv[]) {
         return 1;
     }
 
+    if (useRenderThread) {
+        app.startRenderThread();
+    }
+
+    if (!sharedOutputPass.empty() && !app.setSharedOutput(sharedOutputPass, sharedOutputName)) {
+        return 1;
+    }
+
     if (dumpFramebuffer) {
         app.setDumpFramebuffer(dumpPassName, dumpOutputPath);
         // Force test mode to ensure we run one frame and exit
@@ -615,8 +778,15 @@ void printUsage(const char* programName) {
     LOG_INFO("  --new [path] [-t template]  Create new shader project");
     LOG_INFO("  --export-libs               Export bundled libraries to project's libs/ folder");
     LOG_INFO("  --templates                 List available shader templates");
-    LOG_INFO("  --render-scale-mode MODE    Set render scale mode (chunk, resolution)");
+    LOG_INFO("  --render-scale-mode MODE    Set render scale mode (chunk, resolution, tiled)");
     LOG_INFO("  --render-scale FACTOR       Set initial render scale factor (0.0 - 1.0)");
+    LOG_INFO("  --render-thread             Render passes on a dedicated thread");
+    LOG_INFO("  --shared-output PASS NAME   Publish every frame of PASS to the shared memory ring /NAME");
+    LOG_INFO("  --render-sequence S E FPS WxH OUT  Render frames from S to E seconds to OUT without a window");
+    LOG_INFO("  --render-poster T WxH SS OUT  Render a tiled still at time T with SSxSS supersampling to OUT.png");
+    LOG_INFO("  --sequence-format FORMAT    png frames in the OUT directory, or a y4m/rgba stream to OUT (- for stdout)");
+    LOG_INFO("  --encode-threads N          Threads encoding sequence frames (default: one per core)");
+    LOG_INFO("  --render-workers N          Render the sequence with N worker processes (0: one per core)");
     LOG_INFO("  --test [exit_code]          Run in test mode (exit after one render loop)");
     LOG_INFO("  --debug, -d                 Enable debug output with colors");
     LOG_INFO("  --scale FACTOR              Set UI scale factor (e.g., 1.0, 1.5, 2.0)");
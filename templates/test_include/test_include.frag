@@ -1 +1,12 @@
+#version 330 core
+
+out vec4 FragColor;
+
+in vec2 TexCoord;
+
 #pragma include("<utils.glsl>")
+
+void main() {
+    float c = circle(TexCoord, 0.25);
+    FragColor = vec4(c, 0.5 * c, 1.0 - c, 1.0);
+}
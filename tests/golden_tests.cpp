@@ -0,0 +1,467 @@
+// Golden image regression tests. Every template and the test project are rendered
+// headlessly at fixed times and compared against the reference images in tests/golden
+// with a perceptual tolerance. Shader compile and render times are measured per case and
+// compared against stored baselines, so correctness and performance regressions fail in
+// the same run.
+//
+// Usage: golden-tests <source dir> [--update] [--time-tolerance FACTOR] [--report FILE]
+//
+// --update rewrites the reference images and timing baselines from the current build.
+
+#include "HeadlessRenderer.h"
+#include "PngStreamWriter.h"
+#include "ShaderProject.h"
+#include "ShaderTemplates.h"
+#include "Logger.h"
+#include "json.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include <vector>
+
+#include <unistd.h>
+#include <zlib.h>
+
+using json = nlohmann::json;
+
+// Exit code that makes CTest report the test as skipped
+static const int EXIT_SKIPPED = 77;
+
+static const int IMAGE_WIDTH = 192;
+static const int IMAGE_HEIGHT = 108;
+static const std::vector<float> CASE_TIMES = { 0.0f, 2.5f };
+
+// Perceptual tolerance, in 8-bit units of the weighted YCbCr distance between 2x2 averaged pixels
+static const float MAX_MEAN_DISTANCE = 1.5f;
+static const float BAD_PIXEL_DISTANCE = 16.0f;
+static const float MAX_BAD_PIXEL_FRACTION = 0.005f;
+
+// Timings closer to the baseline than this are noise, whatever the ratio
+static const float TIMING_NOISE_MS = 1.0f;
+
+struct CaseResult {
+    std::string name;
+    bool imagePassed = false;
+    bool timingPassed = false;
+    float meanDistance = 0.0f;
+    float badPixelFraction = 0.0f;
+    float calibrationMs = 0.0f;
+    float compileMs = 0.0f;
+    float renderMs = 0.0f;
+    std::string message;
+};
+
+static float millisecondsSince(std::chrono::steady_clock::time_point start) {
+    return std::chrono::duration<float, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+// A fixed amount of single-threaded work. Timings are stored relative to it, so the
+// baselines roughly hold on machines of different speed (llvmpipe runs on the CPU).
+static float measureCalibration() {
+    float best = 0.0f;
+    for (int run = 0; run < 3; run++) {
+        auto start = std::chrono::steady_clock::now();
+        volatile float sink = 0.0f;
+        float value = 1.0f;
+        for (int i = 0; i < 20000000; i++) {
+            value = value * 1.0000001f + 1e-7f;
+        }
+        sink = value;
+        (void)sink;
+        float elapsed = millisecondsSince(start);
+        best = run == 0 ? elapsed : std::min(best, elapsed);
+    }
+    return best;
+}
+
+static unsigned int readBigEndian(const unsigned char* data) {
+    return (static_cast<unsigned int>(data[0]) << 24) | (static_cast<unsigned int>(data[1]) << 16)
+         | (static_cast<unsigned int>(data[2]) << 8) | data[3];
+}
+
+// Reads 8-bit RGB and RGBA PNGs without interlacing, which covers the references written
+// by --update and by common optimisers
+static bool readPng(const std::string& path, int& width, int& height, std::vector<unsigned char>& rgb) {
+    std::ifstream file(path, std::ios::binary);
+    std::vector<unsigned char> data((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+    if (data.size() < 8 || std::memcmp(data.data(), "\x89PNG\r\n\x1a\n", 8) != 0) {
+        return false;
+    }
+
+    int channels = 0;
+    std::vector<unsigned char> compressed;
+    for (size_t offset = 8; offset + 12 <= data.size();) {
+        unsigned int length = readBigEndian(&data[offset]);
+        const unsigned char* type = &data[offset + 4];
+        const unsigned char* body = &data[offset + 8];
+        if (offset + 12 + length > data.size()) {
+            return false;
+        }
+        if (std::memcmp(type, "IHDR", 4) == 0) {
+            width = static_cast<int>(readBigEndian(body));
+            height = static_cast<int>(readBigEndian(body + 4));
+            if (body[8] != 8 || body[12] != 0 || (body[9] != 2 && body[9] != 6)) {
+                LOG_ERROR("{}: only 8-bit RGB(A) PNGs without interlacing are supported", path);
+                return false;
+            }
+            channels = body[9] == 2 ? 3 : 4;
+        } else if (std::memcmp(type, "IDAT", 4) == 0) {
+            compressed.insert(compressed.end(), body, body + length);
+        }
+        offset += 12 + length;
+    }
+    if (channels == 0 || width <= 0 || height <= 0) {
+        return false;
+    }
+
+    const size_t stride = static_cast<size_t>(width) * channels;
+    std::vector<unsigned char> filtered((stride + 1) * height);
+    uLongf filteredSize = static_cast<uLongf>(filtered.size());
+    if (uncompress(filtered.data(), &filteredSize, compressed.data(), static_cast<uLong>(compressed.size())) != Z_OK
+        || filteredSize != filtered.size()) {
+        return false;
+    }
+
+    std::vector<unsigned char> pixels(stride * height);
+    for (int y = 0; y < height; y++) {
+        const unsigned char* source = &filtered[y * (stride + 1)];
+        unsigned char* row = &pixels[y * stride];
+        const unsigned char* above = y > 0 ? row - stride : nullptr;
+        for (size_t i = 0; i < stride; i++) {
+            int a = i >= static_cast<size_t>(channels) ? row[i - channels] : 0;
+            int b = above ? above[i] : 0;
+            int c = above && i >= static_cast<size_t>(channels) ? above[i - channels] : 0;
+            int predictor = 0;
+            switch (source[0]) {
+                case 1: predictor = a; break;
+                case 2: predictor = b; break;
+                case 3: predictor = (a + b) / 2; break;
+                case 4: {
+                    int p = a + b - c;
+                    int pa = std::abs(p - a), pb = std::abs(p - b), pc = std::abs(p - c);
+                    predictor = (pa <= pb && pa <= pc) ? a : (pb <= pc ? b : c);
+                    break;
+                }
+                default: break;
+            }
+            row[i] = static_cast<unsigned char>(source[1 + i] + predictor);
+        }
+    }
+
+    rgb.resize(static_cast<size_t>(width) * height * 3);
+    for (size_t i = 0; i < static_cast<size_t>(width) * height; i++) {
+        std::memcpy(&rgb[i * 3], &pixels[i * channels], 3);
+    }
+    return true;
+}
+
+static bool writePng(const std::string& path, int width, int height, const std::vector<unsigned char>& rgb) {
+    PngStreamWriter writer;
+    return writer.open(path, width, height) && writer.writeRows(rgb.data(), height) && writer.close();
+}
+
+// Read back images are RGBA with the bottom row first, references RGB top row first
+static std::vector<unsigned char> toRgbTopDown(const std::vector<unsigned char>& rgba, int width, int height) {
+    std::vector<unsigned char> rgb(static_cast<size_t>(width) * height * 3);
+    for (int y = 0; y < height; y++) {
+        const unsigned char* source = &rgba[static_cast<size_t>(height - 1 - y) * width * 4];
+        unsigned char* target = &rgb[static_cast<size_t>(y) * width * 3];
+        for (int x = 0; x < width; x++) {
+            std::memcpy(target + x * 3, source + x * 4, 3);
+        }
+    }
+    return rgb;
+}
+
+// Weighted YCbCr distance of 2x2 averaged pixels. Averaging forgives single-pixel edge
+// differences between drivers, and luma errors weigh more than chroma errors, as for the eye.
+static void compareImages(const std::vector<unsigned char>& expected, const std::vector<unsigned char>& actual,
+                          int width, int height, CaseResult& result, std::vector<unsigned char>& diff) {
+    const int blockWidth = width / 2;
+    const int blockHeight = height / 2;
+    double total = 0.0;
+    int badPixels = 0;
+    diff.assign(static_cast<size_t>(width) * height * 3, 0);
+
+    for (int by = 0; by < blockHeight; by++) {
+        for (int bx = 0; bx < blockWidth; bx++) {
+            float delta[3] = { 0.0f, 0.0f, 0.0f };
+            for (int y = by * 2; y < by * 2 + 2; y++) {
+                for (int x = bx * 2; x < bx * 2 + 2; x++) {
+                    size_t index = (static_cast<size_t>(y) * width + x) * 3;
+                    for (int c = 0; c < 3; c++) {
+                        delta[c] += (static_cast<float>(actual[index + c]) - expected[index + c]) * 0.25f;
+                    }
+                }
+            }
+            float dy = 0.299f * delta[0] + 0.587f * delta[1] + 0.114f * delta[2];
+            float dcb = -0.169f * delta[0] - 0.331f * delta[1] + 0.5f * delta[2];
+            float dcr = 0.5f * delta[0] - 0.419f * delta[1] - 0.081f * delta[2];
+            float distance = std::sqrt(dy * dy + 0.25f * dcb * dcb + 0.25f * dcr * dcr);
+            total += distance;
+            if (distance > BAD_PIXEL_DISTANCE) {
+                badPixels++;
+            }
+
+            unsigned char shade = static_cast<unsigned char>(std::min(255.0f, distance * 8.0f));
+            for (int y = by * 2; y < by * 2 + 2; y++) {
+                for (int x = bx * 2; x < bx * 2 + 2; x++) {
+                    std::memset(&diff[(static_cast<size_t>(y) * width + x) * 3], shade, 3);
+                }
+            }
+        }
+    }
+
+    int blocks = std::max(1, blockWidth * blockHeight);
+    result.meanDistance = static_cast<float>(total / blocks);
+    result.badPixelFraction = static_cast<float>(badPixels) / blocks;
+    result.imagePassed = result.meanDistance <= MAX_MEAN_DISTANCE && result.badPixelFraction <= MAX_BAD_PIXEL_FRACTION;
+}
+
+// Fails if the timing grew past the baseline (relative to the calibration) by more than
+// the tolerance factor and by more than the noise floor
+static bool checkTiming(const json& baselines, const std::string& key, float milliseconds, float calibrationMs,
+                        float tolerance, std::string& message) {
+    if (!baselines.contains(key)) {
+        message += key + " has no baseline. ";
+        return false;
+    }
+    float expectedMs = baselines[key].get<float>() * calibrationMs;
+    if (milliseconds > expectedMs * tolerance && milliseconds - expectedMs > TIMING_NOISE_MS) {
+        message += key + " took " + std::to_string(milliseconds) + "ms, expected about "
+                 + std::to_string(expectedMs) + "ms. ";
+        return false;
+    }
+    return true;
+}
+
+struct ProjectMeasurement {
+    bool loaded = false;
+    float calibrationMs = 0.0f;
+    float compileMs = 0.0f;
+    std::vector<float> renderMs;                        // Per case time
+    std::vector<char> rendered;
+    std::vector<std::vector<unsigned char>> pixels;
+};
+
+static std::string getCaseName(const std::string& project, float time) {
+    char name[64];
+    std::snprintf(name, sizeof(name), "_%04d", static_cast<int>(std::lround(time * 1000.0f)));
+    return project + name;
+}
+
+// Loads the project and renders every case time, timing both. The calibration runs right
+// before, shared machines change speed over a run.
+static bool measureProject(HeadlessRenderer& renderer, const std::string& path, ProjectMeasurement& measurement) {
+    measurement.calibrationMs = measureCalibration();
+    measurement.renderMs.assign(CASE_TIMES.size(), 0.0f);
+    measurement.rendered.assign(CASE_TIMES.size(), 0);
+    measurement.pixels.assign(CASE_TIMES.size(), std::vector<unsigned char>());
+
+    // Compilation includes the first draw, where software drivers build their code.
+    // Best of three loads, the first one also pays for reading the files.
+    std::vector<unsigned char> pixels;
+    measurement.loaded = true;
+    for (int run = 0; measurement.loaded && run < 3; run++) {
+        auto compileStart = std::chrono::steady_clock::now();
+        measurement.loaded = renderer.openProject(path) && renderer.renderImage(0.0f, 16, 16, pixels);
+        float loadMs = millisecondsSince(compileStart);
+        measurement.compileMs = run == 0 ? loadMs : std::min(measurement.compileMs, loadMs);
+    }
+
+    for (size_t i = 0; measurement.loaded && i < CASE_TIMES.size(); i++) {
+        // Best of three, after one untimed frame at the final size
+        bool rendered = renderer.renderImage(CASE_TIMES[i], IMAGE_WIDTH, IMAGE_HEIGHT, measurement.pixels[i]);
+        for (int run = 0; rendered && run < 3; run++) {
+            auto renderStart = std::chrono::steady_clock::now();
+            rendered = renderer.renderImage(CASE_TIMES[i], IMAGE_WIDTH, IMAGE_HEIGHT, measurement.pixels[i]);
+            float renderMs = millisecondsSince(renderStart);
+            measurement.renderMs[i] = run == 0 ? renderMs : std::min(measurement.renderMs[i], renderMs);
+        }
+        measurement.rendered[i] = rendered;
+    }
+    return measurement.loaded;
+}
+
+int main(int argc, char** argv) {
+    if (argc < 2) {
+        LOG_ERROR("Usage: {} <source dir> [--update] [--time-tolerance FACTOR] [--report FILE]", argv[0]);
+        return 1;
+    }
+    std::filesystem::path sourceDir = argv[1];
+    bool update = false;
+    float tolerance = 2.0f;
+    std::string reportPath = "golden-report.json";
+    for (int i = 2; i < argc; i++) {
+        std::string arg = argv[i];
+        if (arg == "--update") {
+            update = true;
+        } else if (arg == "--time-tolerance" && i + 1 < argc) {
+            tolerance = std::stof(argv[++i]);
+        } else if (arg == "--report" && i + 1 < argc) {
+            reportPath = argv[++i];
+        } else {
+            LOG_ERROR("Unknown argument: {}", arg);
+            return 1;
+        }
+    }
+    Logger::getInstance().initialize(false);
+
+    HeadlessRenderer renderer;
+    if (!renderer.initialize()) {
+        LOG_WARN("No headless OpenGL context, skipping the golden image tests");
+        return EXIT_SKIPPED;
+    }
+
+    std::filesystem::path goldenDir = sourceDir / "tests" / "golden";
+    std::filesystem::path timingsPath = goldenDir / "timings.json";
+    json baselines = json::object();
+    if (!update) {
+        std::ifstream timingsFile(timingsPath);
+        if (timingsFile) {
+            timingsFile >> baselines;
+        }
+    }
+
+    // Templates are created from the embedded copies, the same way --new does
+    std::filesystem::path workDir = std::filesystem::temp_directory_path()
+        / ("fork-eater-golden-" + std::to_string(getpid()));
+    std::vector<std::pair<std::string, std::filesystem::path>> projects;
+    for (const auto& templateName : ShaderTemplateManager::getInstance().getTemplateNames()) {
+        ShaderProject project;
+        std::filesystem::path path = workDir / templateName;
+        if (!project.createNew(path.string(), templateName, templateName)) {
+            // Fails its cases below, like a template that does not compile
+            LOG_ERROR("Failed to create a project from template {}", templateName);
+        }
+        projects.push_back({ templateName, path });
+    }
+    projects.push_back({ "test_project", sourceDir / "test_project" });
+
+    std::vector<CaseResult> results;
+    json updatedTimings = json::object();
+    for (const auto& project : projects) {
+        ProjectMeasurement measurement;
+        measureProject(renderer, project.second.string(), measurement);
+
+        // A single slow run on a busy machine is not a regression, timings that miss their
+        // baseline are measured once more and only the second attempt counts
+        auto checkProjectTimings = [&](std::vector<std::string>& messages) {
+            bool passed = true;
+            for (size_t i = 0; i < CASE_TIMES.size(); i++) {
+                std::string name = getCaseName(project.first, CASE_TIMES[i]);
+                bool compileInTime = checkTiming(baselines, project.first + ".compile", measurement.compileMs,
+                                                 measurement.calibrationMs, tolerance, messages[i]);
+                bool renderInTime = checkTiming(baselines, name + ".render", measurement.renderMs[i],
+                                                measurement.calibrationMs, tolerance, messages[i]);
+                passed = passed && compileInTime && renderInTime;
+            }
+            return passed;
+        };
+        std::vector<std::string> timingMessages(CASE_TIMES.size());
+        if (!update && measurement.loaded) {
+            if (!checkProjectTimings(timingMessages)) {
+                LOG_INFO("{} missed its timing baseline, measuring again", project.first);
+                ProjectMeasurement retry;
+                if (measureProject(renderer, project.second.string(), retry)) {
+                    measurement.calibrationMs = retry.calibrationMs;
+                    measurement.compileMs = retry.compileMs;
+                    measurement.renderMs = retry.renderMs;
+                    timingMessages.assign(CASE_TIMES.size(), std::string());
+                    checkProjectTimings(timingMessages);
+                }
+            }
+        }
+
+        for (size_t i = 0; i < CASE_TIMES.size(); i++) {
+            CaseResult result;
+            result.name = getCaseName(project.first, CASE_TIMES[i]);
+            result.calibrationMs = measurement.calibrationMs;
+            result.compileMs = measurement.compileMs;
+            result.renderMs = measurement.renderMs[i];
+            if (!measurement.rendered[i]) {
+                result.message = "Failed to render. ";
+                results.push_back(result);
+                continue;
+            }
+
+            std::vector<unsigned char> actual = toRgbTopDown(measurement.pixels[i], IMAGE_WIDTH, IMAGE_HEIGHT);
+            std::filesystem::path referencePath = goldenDir / (result.name + ".png");
+            if (update) {
+                std::filesystem::create_directories(goldenDir);
+                result.imagePassed = writePng(referencePath.string(), IMAGE_WIDTH, IMAGE_HEIGHT, actual);
+                result.timingPassed = true;
+                updatedTimings[project.first + ".compile"] = measurement.compileMs / measurement.calibrationMs;
+                updatedTimings[result.name + ".render"] = result.renderMs / measurement.calibrationMs;
+                results.push_back(result);
+                continue;
+            }
+
+            int width = 0;
+            int height = 0;
+            std::vector<unsigned char> expected;
+            if (!readPng(referencePath.string(), width, height, expected) || width != IMAGE_WIDTH || height != IMAGE_HEIGHT) {
+                result.message += "No usable reference " + referencePath.string() + ", run with --update. ";
+            } else {
+                std::vector<unsigned char> diff;
+                compareImages(expected, actual, width, height, result, diff);
+                if (!result.imagePassed) {
+                    // Left in the working directory (the build directory under CTest) to inspect
+                    writePng("golden-" + result.name + ".actual.png", width, height, actual);
+                    writePng("golden-" + result.name + ".diff.png", width, height, diff);
+                    result.message += "Image differs (mean " + std::to_string(result.meanDistance) + ", "
+                                    + std::to_string(result.badPixelFraction * 100.0f) + "% bad pixels). ";
+                }
+            }
+
+            // checkTiming only adds messages for timings that failed
+            result.timingPassed = timingMessages[i].empty();
+            result.message += timingMessages[i];
+            results.push_back(result);
+        }
+    }
+
+    std::error_code error;
+    std::filesystem::remove_all(workDir, error);
+
+    json report = json::object();
+    report["cases"] = json::array();
+    int failures = 0;
+    for (const auto& result : results) {
+        bool passed = result.imagePassed && result.timingPassed;
+        if (passed) {
+            LOG_SUCCESS("{}: compile {}ms, render {}ms", result.name, result.compileMs, result.renderMs);
+        } else {
+            LOG_ERROR("{}: {}", result.name, result.message);
+            failures++;
+        }
+        report["cases"].push_back({
+            { "name", result.name },
+            { "passed", passed },
+            { "meanDistance", result.meanDistance },
+            { "badPixelFraction", result.badPixelFraction },
+            { "calibrationMs", result.calibrationMs },
+            { "compileMs", result.compileMs },
+            { "renderMs", result.renderMs }
+        });
+    }
+    std::ofstream(reportPath) << report.dump(2) << "\n";
+
+    if (update) {
+        std::ofstream(timingsPath) << updatedTimings.dump(2) << "\n";
+        LOG_IMPORTANT("Updated {} reference images and timings in {}", results.size(), goldenDir.string());
+        return failures == 0 ? 0 : 1;
+    }
+    if (failures > 0) {
+        LOG_ERROR("{} of {} golden image cases failed", failures, results.size());
+        return 1;
+    }
+    LOG_IMPORTANT("All {} golden image cases passed", results.size());
+    return 0;
+}